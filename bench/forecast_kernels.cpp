@@ -0,0 +1,641 @@
+// microbenchmarks for the forecast kernels: distances, nearest neighbors,
+// simplex and S-map predictions, CCM lib sampling, and forecast statistics;
+// see bench/README.md for the options and the output format
+
+#include <rEDM.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// *** benchmark settings and results *** //
+
+struct Dataset
+{
+    std::string name;
+    vec values;
+};
+
+struct BenchConfig
+{
+    std::vector<size_t> N;
+    std::vector<size_t> E;
+    std::vector<size_t> threads;
+    size_t reps;
+    double min_time;
+    std::string format;
+    std::string out;
+    std::string filter;
+    std::vector<Dataset> datasets;
+};
+
+struct BenchResult
+{
+    std::string kernel;
+    std::string variant;
+    std::string dataset;
+    size_t N, E, threads, reps;
+    double min_ns, median_ns, mean_ns;
+};
+
+// *** access to the kernels *** //
+
+// exposes the protected kernels of the engine; lib is the first half of the
+// series and pred the second half, so there is no cross-validation
+class LNLPBench: public LNLP
+{
+public:
+    void setup(const vec& x, const size_t new_E, const size_t new_nn,
+               const int pred_type, const double norm, const double new_theta,
+               const bool single)
+    {
+        vec t(x.size());
+        for(size_t i = 0; i < x.size(); ++i)
+            t[i] = double(i + 1);
+        size_t half = x.size() / 2;
+        set_time(t);
+        set_time_series(x);
+        set_norm(norm);
+        set_pred_type(pred_type);
+        set_lib(std::vector<time_range>(1, time_range(0, half - 1)));
+        set_pred(std::vector<time_range>(1, time_range(half, x.size() - 1)));
+        set_params(new_E, 1, 1, new_nn);
+        set_theta(new_theta);
+        suppress_warnings();
+        set_single_precision(single);
+        run();
+        return;
+    }
+
+    void reset_distances()
+    {
+        for(auto& row: distances)
+            std::fill(row.begin(), row.end(), qnan);
+        for(auto& row: float_distances)
+            std::fill(row.begin(), row.end(), std::numeric_limits<float>::quiet_NaN());
+        return;
+    }
+
+    void distances_kernel()
+    {
+        compute_distances();
+        return;
+    }
+
+    size_t neighbors_kernel()
+    {
+        size_t total = 0;
+        for(auto curr_pred: which_pred)
+        {
+            find_nearest_neighbors(distance_row(curr_pred), curr_pred, 
+                                   pred_scratch.neighbors, pred_scratch);
+            total += pred_scratch.neighbors.size();
+        }
+        return total;
+    }
+
+    void forecast_kernel()
+    {
+        forecast();
+        return;
+    }
+
+    size_t num_pred() const
+    {
+        return which_pred.size();
+    }
+};
+
+// *** synthetic data *** //
+
+// logistic map (r = 3.8) with small observation noise; the same seed always
+// gives the same series
+vec logistic_series(const size_t n, const unsigned long seed)
+{
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> noise(0, 0.01);
+    vec x(n);
+    double state = 0.4;
+    for(size_t i = 0; i < n + 100; ++i)
+    {
+        state = 3.8 * state * (1 - state);
+        if(i >= 100)
+            x[i - 100] = state + noise(rng);
+    }
+    return x;
+}
+
+// the logistic map rounded to a few levels, so that most distances are tied
+vec tied_series(const size_t n, const unsigned long seed)
+{
+    vec x = logistic_series(n, seed);
+    for(auto& xi: x)
+        xi = std::round(xi * 8) / 8;
+    return x;
+}
+
+// first numeric column of a CSV file (or the column given after ':'),
+// skipping a header and any non-numeric entries
+Dataset read_csv_dataset(const std::string& spec)
+{
+    std::string path = spec;
+    size_t column = 0;
+    size_t colon = spec.rfind(':');
+    if(colon != std::string::npos && colon + 1 < spec.size() &&
+       spec.find_first_not_of("0123456789", colon + 1) == std::string::npos)
+    {
+        path = spec.substr(0, colon);
+        column = std::stoul(spec.substr(colon + 1)) - 1;
+    }
+    std::ifstream in(path.c_str());
+    if(!in)
+    {
+        throw std::domain_error("unable to open " + path);
+    }
+
+    Dataset output;
+    size_t slash = path.find_last_of("/\\");
+    output.name = path.substr(slash == std::string::npos ? 0 : slash + 1);
+    output.name = output.name.substr(0, output.name.rfind(".csv"));
+    std::string line;
+    while(std::getline(in, line))
+    {
+        std::stringstream fields(line);
+        std::string field;
+        for(size_t j = 0; std::getline(fields, field, ','); ++j)
+        {
+            if(j != column)
+                continue;
+            char* end;
+            double value = strtod(field.c_str(), &end);
+            if(end != field.c_str())
+                output.values.push_back(value);
+        }
+    }
+    if(output.values.size() < 10)
+    {
+        throw std::domain_error(path + " has fewer than 10 values");
+    }
+    return output;
+}
+
+// *** timing *** //
+
+typedef std::chrono::steady_clock bench_clock;
+
+// runs setup (untimed) and then body on each of num_threads independent
+// instances at once, reps times or until min_time seconds have passed;
+// returns the wall time of each rep in ns
+template <typename Instance, typename Setup, typename Body>
+vec time_kernel(std::vector<std::unique_ptr<Instance> >& instances, const BenchConfig& config,
+                Setup setup, Body body)
+{
+    vec times;
+    double total = 0;
+    while(times.size() < config.reps || (total < config.min_time * 1e9 && times.size() < 100 * config.reps))
+    {
+        for(auto& instance: instances)
+            setup(*instance);
+        auto start = bench_clock::now();
+        if(instances.size() == 1)
+        {
+            body(*instances[0]);
+        }
+        else
+        {
+            std::vector<std::thread> workers;
+            for(auto& instance: instances)
+            {
+                Instance* ptr = instance.get();
+                workers.push_back(std::thread([ptr, &body]() {body(*ptr);}));
+            }
+            for(auto& tt: workers)
+                tt.join();
+        }
+        double elapsed = std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+        times.push_back(elapsed);
+        total += elapsed;
+    }
+    return times;
+}
+
+void summarize_times(vec times, BenchResult& result)
+{
+    std::sort(times.begin(), times.end());
+    size_t n = times.size();
+    result.reps = n;
+    result.min_ns = times[0];
+    result.median_ns = (n % 2 == 1) ? times[n / 2] : 0.5 * (times[n / 2 - 1] + times[n / 2]);
+    result.mean_ns = std::accumulate(times.begin(), times.end(), 0.0) / double(n);
+    return;
+}
+
+// keeps the optimizer from discarding a result
+std::atomic<size_t> bench_sink(0);
+
+// *** benchmarks *** //
+
+class BenchRunner
+{
+public:
+    BenchRunner(const BenchConfig& new_config): config(new_config) {}
+
+    void run_all()
+    {
+        for(auto& data: config.datasets)
+        {
+            for(auto N: config.N)
+            {
+                if(N > data.values.size() || N < 10)
+                    continue;
+                vec x(data.values.begin(), data.values.begin() + N);
+                for(auto E: config.E)
+                {
+                    if(E >= N / 4)
+                        continue;
+                    for(auto T: config.threads)
+                    {
+                        bench_distances(data.name, x, E, T);
+                        bench_neighbors(data.name, x, E, T);
+                        bench_forecasts(data.name, x, E, T);
+                        bench_xmap(data.name, x, E, T);
+                        bench_stats(data.name, x, E, T);
+                    }
+                }
+            }
+        }
+        return;
+    }
+
+    const std::vector<BenchResult>& get_results() const
+    {
+        return results;
+    }
+
+private:
+    bool selected(const std::string& kernel) const
+    {
+        return config.filter.empty() || kernel.find(config.filter) != std::string::npos;
+    }
+
+    std::vector<std::unique_ptr<LNLPBench> > make_lnlp(const vec& x, const size_t E,
+                                                      const size_t T, const size_t nn,
+                                                      const int pred_type, const double norm,
+                                                      const bool single = false)
+    {
+        std::vector<std::unique_ptr<LNLPBench> > instances;
+        for(size_t t = 0; t < T; ++t)
+        {
+            instances.push_back(std::unique_ptr<LNLPBench>(new LNLPBench()));
+            instances.back()->setup(x, E, nn, pred_type, norm, 2.0, single);
+        }
+        return instances;
+    }
+
+    void record(const std::string& kernel, const std::string& variant,
+                const std::string& dataset, const size_t N, const size_t E,
+                const size_t T, const vec& times)
+    {
+        BenchResult result;
+        result.kernel = kernel;
+        result.variant = variant;
+        result.dataset = dataset;
+        result.N = N;
+        result.E = E;
+        result.threads = T;
+        summarize_times(times, result);
+        results.push_back(result);
+        std::cerr << kernel << " " << variant << " " << dataset << " N=" << N
+                  << " E=" << E << " threads=" << T << ": "
+                  << result.median_ns / 1e6 << " ms\n";
+        return;
+    }
+
+    void bench_distances(const std::string& dataset, const vec& x, const size_t E, const size_t T)
+    {
+        if(!selected("compute_distances"))
+            return;
+        const double norms[] = {1, 2, 3, 2.5, std::numeric_limits<double>::infinity()};
+        const char* names[] = {"L1", "L2", "P3", "P2.5", "Linf"};
+        for(size_t k = 0; k < 5; ++k)
+        {
+            auto instances = make_lnlp(x, E, T, E + 1, 2, norms[k]);
+            vec times = time_kernel(instances, config,
+                                    [](LNLPBench& m) {m.reset_distances();},
+                                    [](LNLPBench& m) {m.distances_kernel();});
+            record("compute_distances", names[k], dataset, x.size(), E, T, times);
+        }
+        auto instances = make_lnlp(x, E, T, E + 1, 2, 2, true);
+        vec times = time_kernel(instances, config,
+                                [](LNLPBench& m) {m.reset_distances();},
+                                [](LNLPBench& m) {m.distances_kernel();});
+        record("compute_distances", "L2,single", dataset, x.size(), E, T, times);
+        return;
+    }
+
+    void bench_neighbors(const std::string& dataset, const vec& x, const size_t E, const size_t T)
+    {
+        if(!selected("find_nearest_neighbors"))
+            return;
+
+        // nn = 1 and E+1 use insertion, 50 sorts the lib, 0 returns the whole lib
+        const size_t nn_values[] = {1, E + 1, 50, 0};
+        for(auto nn: nn_values)
+        {
+            auto instances = make_lnlp(x, E, T, nn, 2, 2);
+            vec times = time_kernel(instances, config, [](LNLPBench&) {},
+                                    [](LNLPBench& m) {bench_sink += m.neighbors_kernel();});
+            record("find_nearest_neighbors", "nn=" + std::to_string(nn), dataset,
+                   x.size(), E, T, times);
+        }
+        auto instances = make_lnlp(x, E, T, E + 1, 2, 2, true);
+        vec times = time_kernel(instances, config, [](LNLPBench&) {},
+                                [](LNLPBench& m) {bench_sink += m.neighbors_kernel();});
+        record("find_nearest_neighbors", "nn=E+1,single", dataset, x.size(), E, T, times);
+        return;
+    }
+
+    void bench_forecasts(const std::string& dataset, const vec& x, const size_t E, const size_t T)
+    {
+        if(selected("simplex_prediction"))
+        {
+            auto instances = make_lnlp(x, E, T, E + 1, 2, 2);
+            vec times = time_kernel(instances, config, [](LNLPBench&) {},
+                                    [](LNLPBench& m) {m.forecast_kernel();});
+            record("simplex_prediction", "nn=E+1", dataset, x.size(), E, T, times);
+
+            // neighbors from a pivot index, without the distance matrix
+            instances = make_lnlp(x, E, T, E + 1, 2, 2);
+            for(auto& instance: instances)
+                instance->set_pivot_index(16);
+            times = time_kernel(instances, config, [](LNLPBench&) {},
+                                [](LNLPBench& m) {m.forecast_kernel();});
+            record("simplex_prediction", "nn=E+1,pivots", dataset, x.size(), E, T, times);
+        }
+        if(selected("smap_prediction"))
+        {
+            const size_t nn_values[] = {0, E + 1};
+            for(auto nn: nn_values)
+            {
+                auto instances = make_lnlp(x, E, T, nn, 1, 2);
+                vec times = time_kernel(instances, config, [](LNLPBench&) {},
+                                        [](LNLPBench& m) {m.forecast_kernel();});
+                record("smap_prediction", nn == 0 ? "nn=0" : "nn=E+1", dataset,
+                       x.size(), E, T, times);
+            }
+        }
+        return;
+    }
+
+    void bench_xmap(const std::string& dataset, const vec& x, const size_t E, const size_t T)
+    {
+        if(!selected("xmap_run"))
+            return;
+
+        // cross map x from a noisy copy of itself, over 3 lib sizes
+        size_t N = x.size();
+        std::mt19937_64 rng(42);
+        std::normal_distribution<double> noise(0, 0.05);
+        std::vector<vec> block(2, x);
+        for(auto& yi: block[1])
+            yi += noise(rng);
+        vec t(N);
+        for(size_t i = 0; i < N; ++i)
+            t[i] = double(i + 1);
+        std::vector<size_t> lib_sizes = {N / 4, N / 2, N};
+
+        std::vector<std::unique_ptr<Xmap> > instances;
+        for(size_t k = 0; k < T; ++k)
+        {
+            instances.push_back(std::unique_ptr<Xmap>(new Xmap()));
+            Xmap& m = *instances.back();
+            m.set_time(t);
+            m.set_block(block);
+            m.set_norm(2);
+            m.set_lib(std::vector<time_range>(1, time_range(0, N - 1)));
+            m.set_pred(std::vector<time_range>(1, time_range(0, N - 1)));
+            m.set_lib_sizes(lib_sizes);
+            m.set_exclusion_radius(0);
+            m.set_lib_column(1);
+            m.set_target_column(2);
+            m.set_params(E, 1, 0, E + 1, true, 20, true);
+            m.suppress_warnings();
+        }
+        vec times = time_kernel(instances, config, [](Xmap& m) {m.set_seed(42);},
+                                [](Xmap& m) {m.run();});
+        record("xmap_run", "random_libs,num_samples=20", dataset, N, E, T, times);
+        return;
+    }
+
+    void bench_stats(const std::string& dataset, const vec& x, const size_t E, const size_t T)
+    {
+        if(!selected("compute_stats"))
+            return;
+
+        // one-step persistence forecast, with the first E values missing
+        struct StatsInstance
+        {
+            vec obs, pred;
+        };
+        std::vector<std::unique_ptr<StatsInstance> > instances;
+        for(size_t k = 0; k < T; ++k)
+        {
+            instances.push_back(std::unique_ptr<StatsInstance>(new StatsInstance()));
+            instances.back()->obs = x;
+            instances.back()->pred.assign(x.size(), std::numeric_limits<double>::quiet_NaN());
+            for(size_t i = E; i < x.size(); ++i)
+                instances.back()->pred[i] = x[i - 1];
+        }
+        vec times = time_kernel(instances, config, [](StatsInstance&) {},
+                                [](StatsInstance& s) {
+                                    bench_sink += compute_stats_internal(s.obs, s.pred).num_pred;
+                                });
+        record("compute_stats_internal", "persistence", dataset, x.size(), E, T, times);
+        return;
+    }
+
+    BenchConfig config;
+    std::vector<BenchResult> results;
+};
+
+// *** output *** //
+
+void write_csv(std::ostream& out, const std::vector<BenchResult>& results)
+{
+    out << "kernel,variant,dataset,N,E,threads,reps,min_ns,median_ns,mean_ns\n";
+    for(auto& r: results)
+    {
+        out << r.kernel << ",\"" << r.variant << "\"," << r.dataset << "," << r.N << ","
+            << r.E << "," << r.threads << "," << r.reps << "," << std::fixed << std::setprecision(0)
+            << r.min_ns << "," << r.median_ns << "," << r.mean_ns << "\n";
+        out.unsetf(std::ios_base::floatfield);
+        out << std::setprecision(6);
+    }
+    return;
+}
+
+void write_json(std::ostream& out, const std::vector<BenchResult>& results)
+{
+    out << "[\n";
+    for(size_t k = 0; k < results.size(); ++k)
+    {
+        const BenchResult& r = results[k];
+        out << "  {\"kernel\": \"" << r.kernel << "\", \"variant\": \"" << r.variant
+            << "\", \"dataset\": \"" << r.dataset << "\", \"N\": " << r.N
+            << ", \"E\": " << r.E << ", \"threads\": " << r.threads
+            << ", \"reps\": " << r.reps << std::fixed << std::setprecision(0)
+            << ", \"min_ns\": " << r.min_ns << ", \"median_ns\": " << r.median_ns
+            << ", \"mean_ns\": " << r.mean_ns << "}"
+            << (k + 1 < results.size() ? ",\n" : "\n");
+        out.unsetf(std::ios_base::floatfield);
+        out << std::setprecision(6);
+    }
+    out << "]\n";
+    return;
+}
+
+// *** command line *** //
+
+std::vector<size_t> parse_sizes(const std::string& arg)
+{
+    std::vector<size_t> output;
+    std::stringstream fields(arg);
+    std::string field;
+    while(std::getline(fields, field, ','))
+        output.push_back(std::stoul(field));
+    if(output.empty())
+    {
+        throw std::domain_error("expected a comma-separated list of sizes");
+    }
+    return output;
+}
+
+void print_usage()
+{
+    std::cerr <<
+        "usage: redm_bench [options]\n"
+        "  --N 250,1000,4000     series lengths\n"
+        "  --E 2,4,8             embedding dimensions\n"
+        "  --threads 1,4         number of independent instances run at once\n"
+        "  --reps 5              minimum number of reps per benchmark\n"
+        "  --min-time 0.2        minimum total time per benchmark (seconds)\n"
+        "  --filter NAME         only run kernels whose names contain NAME\n"
+        "  --data FILE[:COL]     add a CSV column as a dataset (repeatable)\n"
+        "  --no-synthetic        skip the synthetic datasets\n"
+        "  --format csv|json     output format (default csv)\n"
+        "  --out FILE            write results to FILE instead of stdout\n"
+        "  --quick               N = 200, E = 3, threads = 1, reps = 1\n";
+    return;
+}
+
+int main(int argc, char** argv)
+{
+    BenchConfig config;
+    config.N = {250, 1000, 4000};
+    config.E = {2, 4, 8};
+    config.threads = {1};
+    config.reps = 5;
+    config.min_time = 0.2;
+    config.format = "csv";
+    bool synthetic = true;
+    std::vector<std::string> data_files;
+
+    try
+    {
+        for(int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            auto next = [&]() -> std::string {
+                if(i + 1 >= argc)
+                    throw std::domain_error("missing value for " + arg);
+                return argv[++i];
+            };
+            if(arg == "--N")
+                config.N = parse_sizes(next());
+            else if(arg == "--E")
+                config.E = parse_sizes(next());
+            else if(arg == "--threads")
+                config.threads = parse_sizes(next());
+            else if(arg == "--reps")
+                config.reps = std::stoul(next());
+            else if(arg == "--min-time")
+                config.min_time = std::stod(next());
+            else if(arg == "--filter")
+                config.filter = next();
+            else if(arg == "--data")
+                data_files.push_back(next());
+            else if(arg == "--no-synthetic")
+                synthetic = false;
+            else if(arg == "--format")
+                config.format = next();
+            else if(arg == "--out")
+                config.out = next();
+            else if(arg == "--quick")
+            {
+                config.N = {200};
+                config.E = {3};
+                config.threads = {1};
+                config.reps = 1;
+                config.min_time = 0;
+            }
+            else
+            {
+                print_usage();
+                return arg == "--help" ? 0 : 1;
+            }
+        }
+        if(config.format != "csv" && config.format != "json")
+        {
+            throw std::domain_error("format must be csv or json");
+        }
+        config.reps = std::max(config.reps, size_t(1));
+
+        size_t max_N = *std::max_element(config.N.begin(), config.N.end());
+        if(synthetic)
+        {
+            config.datasets.push_back(Dataset{"logistic", logistic_series(max_N, 1)});
+            config.datasets.push_back(Dataset{"logistic_ties", tied_series(max_N, 1)});
+        }
+        for(auto& spec: data_files)
+        {
+            // bundled datasets are shorter than most N, so they are also
+            // run at their full length
+            Dataset data = read_csv_dataset(spec);
+            if(std::find(config.N.begin(), config.N.end(), data.values.size()) == config.N.end())
+                config.N.push_back(data.values.size());
+            config.datasets.push_back(data);
+        }
+
+        BenchRunner runner(config);
+        runner.run_all();
+
+        std::ofstream file;
+        if(!config.out.empty())
+        {
+            file.open(config.out.c_str());
+            if(!file)
+                throw std::domain_error("unable to open " + config.out);
+        }
+        std::ostream& out = config.out.empty() ? std::cout : file;
+        if(config.format == "json")
+            write_json(out, runner.get_results());
+        else
+            write_csv(out, runner.get_results());
+    }
+    catch(std::exception& e)
+    {
+        std::cerr << "redm_bench: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,25 @@
+#ifndef REDM_H
+#define REDM_H
+
+// Public headers for the rEDM forecasting engine: simplex projection and 
+// S-map (LNLP for lagged coordinates of a time series, BlockLNLP for 
+// columns of a block), convergent cross mapping (Xmap), and the forecast 
+// statistics (compute_stats_internal). The engine only needs Eigen and the 
+// C++11 standard library, and is header-only, so packages can call it from 
+// their own compiled code with
+//
+//   LinkingTo: rEDM, RcppEigen
+//
+// and #include <rEDM.h>. Nothing here calls into R: warnings are discarded 
+// unless a handler is given with set_warning_handler(), and Xmap samples 
+// random libs from its own engine (see Xmap::set_seed()) unless a generator 
+// such as R::runif is given with set_uniform_generator(). Each object holds 
+// all of its state, so separate objects can be run on separate threads.
+
+#include "rEDM/data_types.h"
+#include "rEDM/forecast_machine.h"
+#include "rEDM/lnlp.h"
+#include "rEDM/block_lnlp.h"
+#include "rEDM/xmap.h"
+
+#endif
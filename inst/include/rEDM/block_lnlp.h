@@ -1,12 +1,12 @@
-#ifndef BLOCK_LNLP_H
-#define BLOCK_LNLP_H
+#ifndef REDM_BLOCK_LNLP_H
+#define REDM_BLOCK_LNLP_H
 
-#include <Rcpp.h>
 #include <iostream>
 #include "forecast_machine.h"
 
-using namespace Rcpp;
-
+// simplex projection and S-map on columns of a block, given as a vector of 
+// columns; the embedding and target columns are 1-indexed, and lib and pred 
+// ranges are 0-indexed rows, inclusive at both ends
 class BlockLNLP: public ForecastMachine
 {
 public:
@@ -14,25 +14,27 @@ public:
     BlockLNLP();
     
     // *** methods *** //
-    void set_time(const NumericVector time);
-    void set_block(const NumericMatrix new_block);
+    void set_time(const vec& time);
+    void set_block(const std::vector<vec>& new_block);
     void set_norm(const double norm);
     void set_pred_type(const int pred_type);
-    void set_lib(const NumericMatrix lib);
-    void set_pred(const NumericMatrix pred);
+    void set_lib(const std::vector<time_range>& lib);
+    void set_pred(const std::vector<time_range>& pred);
     void set_exclusion_radius(const double new_exclusion_radius);
     void set_epsilon(const double new_epsilon);
-    void set_embedding(const NumericVector new_embedding);
+    void set_embedding(const std::vector<size_t>& new_embedding);
     void set_target_column(const size_t new_target);
     void set_params(const int new_tp, const size_t new_nn);
     void set_theta(const double new_theta);
     void suppress_warnings();
     void save_smap_coefficients();
     void run();
-    DataFrame get_output();
-    DataFrame get_smap_coefficients();
-    List get_smap_coefficient_covariances();
-    DataFrame get_stats();
+    size_t get_output_size();
+    void get_output(double* time, double* obs, double* pred, double* pred_var);
+    std::vector<vec> get_smap_coefficients();
+    PackedCovariances get_smap_coefficient_covariances();
+    PredStats get_stats();
+    PredStats get_const_stats();
     
 private:
     void prepare_forecast();
@@ -50,4 +52,6 @@ private:
     bool remake_ranges;
 };
 
+#include "block_lnlp_impl.h"
+
 #endif
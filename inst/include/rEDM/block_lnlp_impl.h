@@ -0,0 +1,262 @@
+#ifndef REDM_BLOCK_LNLP_IMPL_H
+#define REDM_BLOCK_LNLP_IMPL_H
+
+// definitions for block_lnlp.h, which includes this file; all of them are 
+// inline, so that other packages can use the engine from the headers alone
+
+/*** Constructors ***/
+inline BlockLNLP::BlockLNLP(): 
+    block(std::vector<vec>()), tp(0), E(0), embedding(std::vector<size_t>()), target(0), 
+    remake_vectors(true), remake_targets(true), remake_ranges(true)
+{
+    EPSILON_INDEX = true;
+}
+
+inline void BlockLNLP::set_time(const vec& new_time)
+{
+    time = new_time;
+    return;
+}
+
+inline void BlockLNLP::set_block(const std::vector<vec>& new_block)
+{
+    block = new_block;
+    num_vectors = block.empty() ? 0 : block[0].size();
+    init_distances();
+    return;
+}
+
+inline void BlockLNLP::set_norm(const double norm)
+{
+    if(norm == 1)
+    {
+        norm_mode = L1_NORM;
+    } else if (norm == 2) {
+        norm_mode = L2_NORM;
+    } else if (std::isinf(norm)) {
+        norm_mode = LINF_NORM;
+    } else {
+        norm_mode = P_NORM;
+        p = norm;
+    }
+    return;
+}
+
+inline void BlockLNLP::set_pred_type(const int pred_type)
+{
+    switch(pred_type)
+    {
+        case 1:
+            pred_mode = SMAP;
+            break;
+        case 2:
+            pred_mode = SIMPLEX;
+            break;
+        case 3:
+            pred_mode = FAST_LINEAR;
+            break;
+        default:
+            throw(std::domain_error("unknown pred type selected"));
+    }
+    return;
+}
+
+inline void BlockLNLP::set_lib(const std::vector<time_range>& lib)
+{
+    lib_ranges = lib;
+    remake_ranges = true;
+    return;
+}
+
+inline void BlockLNLP::set_pred(const std::vector<time_range>& pred)
+{
+    pred_ranges = pred;
+    remake_ranges = true;
+    return;
+}
+
+inline void BlockLNLP::set_exclusion_radius(const double new_exclusion_radius)
+{
+    exclusion_radius = new_exclusion_radius;
+    if(exclusion_radius >= 0)
+        CROSS_VALIDATION = true;
+    return;
+}
+
+inline void BlockLNLP::set_epsilon(const double new_epsilon)
+{
+    epsilon = new_epsilon;
+    if(epsilon >= 0)
+    {
+        // range queries go through a pivot index (see uses_pivot_index)
+        std::vector<vec>().swap(distances);
+        std::vector<fvec>().swap(float_distances);
+    }
+    return;
+}
+
+inline void BlockLNLP::set_embedding(const std::vector<size_t>& new_embedding)
+{
+    embedding = new_embedding;
+    E = embedding.size();
+    remake_vectors = true;
+    return;
+}
+
+inline void BlockLNLP::set_target_column(const size_t new_target)
+{
+    target = new_target;
+    remake_targets = true;
+    return;
+}
+
+inline void BlockLNLP::set_params(const int new_tp, const size_t new_nn)
+{
+    if(tp != new_tp)
+        remake_targets = true;
+    if(remake_vectors || remake_targets)
+        remake_ranges = true;
+    
+    tp = new_tp;
+    nn = new_nn;    
+    return;
+}
+
+inline void BlockLNLP::set_theta(const double new_theta)
+{
+    theta = new_theta;
+    return;
+}
+
+inline void BlockLNLP::suppress_warnings()
+{
+    SUPPRESS_WARNINGS = true;
+    return;
+}
+
+inline void BlockLNLP::save_smap_coefficients()
+{
+    SAVE_SMAP_COEFFICIENTS = true;
+    return;
+}
+
+inline void BlockLNLP::run()
+{
+    PhaseTimer timer(profiler(), PHASE_RUN);
+    warning_log.clear();
+    reset_approx_recall();
+    prepare_forecast(); // check parameters
+    forecast(); // forecast code is in forecast_machine
+    flush_warnings();
+    return;
+}
+
+inline size_t BlockLNLP::get_output_size()
+{
+    return count_output_rows();
+}
+
+inline void BlockLNLP::get_output(double* time, double* obs, double* pred, double* pred_var)
+{
+    write_output(time, obs, pred, pred_var);
+    return;
+}
+
+inline std::vector<vec> BlockLNLP::get_smap_coefficients()
+{
+    return make_smap_coefficients_output();
+}
+
+inline PackedCovariances BlockLNLP::get_smap_coefficient_covariances()
+{
+    return make_smap_coefficient_covariances_output();
+}
+
+inline PredStats BlockLNLP::get_stats()
+{
+    return make_stats();
+}
+
+inline PredStats BlockLNLP::get_const_stats()
+{
+    return make_const_stats();
+}
+
+// *** PRIVATE METHODS FOR INTERNAL USE ONLY *** //
+
+inline void BlockLNLP::prepare_forecast()
+{
+    if(remake_vectors)
+    {
+        make_vectors();
+        init_distances();
+    }
+    
+    if(remake_targets)
+        make_targets();
+        
+    if(remake_ranges)
+    {
+        set_indices_from_range(lib_indices, lib_ranges, 0, -std::max(0, tp), true);
+        set_indices_from_range(pred_indices, pred_ranges, 0, -std::max(0, tp), false);
+        set_pred_requested_indices_from_range(pred_requested_indices, pred_ranges);
+
+        check_cross_validation();
+
+        which_lib = which_indices_true(lib_indices);
+        which_pred = which_indices_true(pred_indices);
+
+        remake_ranges = false;
+    }
+    
+    compute_distances();
+    //sort_neighbors();
+    
+    return;
+}
+
+inline void BlockLNLP::make_vectors()
+{
+    PhaseTimer timer(profiler(), PHASE_MAKE_VECTORS);
+    
+    data_vectors.assign(num_vectors, vec(E, qnan));
+    for(size_t i = 0; i < num_vectors; ++i)
+    {
+        for(size_t j = 0; j < E; ++j)
+        {
+            data_vectors[i][j] = block[embedding[j]-1][i];
+        }
+    }
+
+    remake_vectors = false;
+    return;
+}
+
+inline void BlockLNLP::make_targets()
+{
+    if((target < 1) || (target-1 >= block.size()))
+    {
+        throw std::domain_error("invalid target column");
+    }
+    
+    targets.clear();
+    if(tp >= 0)
+    {
+        targets.assign(block[target-1].begin()+tp, block[target-1].end());
+        targets.insert(targets.end(), tp, qnan);
+        target_time.assign(time.begin()+tp, time.end());
+        target_time.insert(target_time.end(), tp, qnan);
+    }
+    else
+    {
+        targets.assign(block[target-1].begin(), block[target-1].end()+tp);
+        targets.insert(targets.begin(), -tp, qnan);
+        target_time.assign(time.begin(), time.end()+tp);
+        target_time.insert(target_time.begin(), -tp, qnan);
+    }
+    const_targets = block[target-1];
+    remake_targets = false;
+    return;
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef REDM_DATA_TYPES_H
+#define REDM_DATA_TYPES_H
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+// shortcut name for vector<double> for in attractor reconstruction
+typedef std::vector<double> vec;
+typedef std::vector<float> fvec;
+typedef std::pair<size_t, size_t> time_range;
+
+// which prediction method to use
+enum PredEnum
+{
+    SIMPLEX,
+    SMAP,
+    FAST_LINEAR
+};
+
+enum NormEnum
+{
+    L1_NORM,
+    L2_NORM, 
+    P_NORM, 
+    LINF_NORM
+};
+
+struct PredStats
+{
+    size_t num_pred;
+    double rho;
+    double mae;
+    double rmse;
+    double perc;
+    double p_val;
+};
+
+// forecasts of several models (e.g. one per lib sample) over the same 
+// requested pred rows, by column: time and obs are stored once, and pred and 
+// pred_var hold the rows of model k at [k n, (k + 1) n), for n rows per model
+struct ModelOutput
+{
+    ModelOutput(): num_models(0) {}
+    
+    size_t num_rows() const
+    {
+        return time.size();
+    }
+    
+    size_t num_models;
+    vec time;
+    vec obs;
+    vec pred;
+    vec pred_var;
+};
+
+// symmetric matrices of size dim, each stored as its upper triangle, packed
+// row by row in dim (dim + 1) / 2 values
+struct PackedCovariances
+{
+    PackedCovariances(): dim(0) {}
+    
+    size_t packed_size() const
+    {
+        return dim * (dim + 1) / 2;
+    }
+    
+    size_t size() const
+    {
+        return computed.size();
+    }
+    
+    const double* matrix(const size_t k) const
+    {
+        return values.data() + k * packed_size();
+    }
+    
+    size_t dim;
+    vec values;
+    std::vector<char> computed; // per matrix; the others are NaN
+};
+
+#endif
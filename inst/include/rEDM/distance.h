@@ -0,0 +1,101 @@
+#ifndef REDM_DISTANCE_H
+#define REDM_DISTANCE_H
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <cstddef>
+#include "data_types.h"
+
+// distance kernels between two vectors of n coordinates. Each sums a power
+// of the coordinate differences (the max for LINF_NORM), and checks the
+// sum against the same power of bound every few coordinates: once it is
+// over, the distance must be greater than bound, and infinity is returned
+// without the remaining coordinates. With the default bound, the full
+// distance is always returned.
+
+// the sum is compared against a slightly loosened bound, so that rounding
+// in the power of bound can't abandon a distance that is equal to it
+template <typename T>
+inline T loosen_bound(const T limit)
+{
+    return limit * (T(1) + 16 * std::numeric_limits<T>::epsilon());
+}
+
+template <typename T, typename Term>
+inline T accumulate_distance(const T* a, const T* b, const size_t n, const T limit,
+                             Term term)
+{
+    T sum = 0;
+    size_t k = 0;
+    while(k < n)
+    {
+        for(size_t end = std::min(k + 4, n); k < end; ++k)
+            term(sum, a[k] - b[k]);
+        if(sum > limit)
+            return std::numeric_limits<T>::infinity();
+    }
+    return sum;
+}
+
+template <typename T>
+inline T l1_distance(const T* a, const T* b, const size_t n,
+                     const T bound = std::numeric_limits<T>::infinity())
+{
+    return accumulate_distance(a, b, n, loosen_bound(bound),
+                               [](T& sum, const T d) {sum += std::abs(d);});
+}
+
+template <typename T>
+inline T l2_distance(const T* a, const T* b, const size_t n,
+                     const T bound = std::numeric_limits<T>::infinity())
+{
+    return std::sqrt(accumulate_distance(a, b, n, loosen_bound(bound * bound),
+                                         [](T& sum, const T d) {sum += d * d;}));
+}
+
+template <typename T>
+inline T linf_distance(const T* a, const T* b, const size_t n,
+                       const T bound = std::numeric_limits<T>::infinity())
+{
+    return accumulate_distance(a, b, n, bound,
+                               [](T& sum, const T d) {sum = std::max(sum, std::abs(d));});
+}
+
+// p = 3 is multiplied out, instead of calling pow for each coordinate
+template <typename T>
+inline T p_distance(const T* a, const T* b, const size_t n, const double p,
+                    const T bound = std::numeric_limits<T>::infinity())
+{
+    if(p == 3)
+    {
+        return std::cbrt(accumulate_distance(a, b, n, loosen_bound(bound * bound * bound),
+                                             [](T& sum, const T d) {
+                                                 T abs_d = std::abs(d);
+                                                 sum += abs_d * abs_d * abs_d;}));
+    }
+    T limit = loosen_bound(T(std::pow(bound, p)));
+    return T(std::pow(accumulate_distance(a, b, n, limit,
+                                          [p](T& sum, const T d) {
+                                              sum += T(std::pow(std::abs(d), p));}),
+                      1 / p));
+}
+
+template <typename T>
+inline T partial_distance(const T* a, const T* b, const size_t n, const NormEnum norm,
+                          const double p, const T bound = std::numeric_limits<T>::infinity())
+{
+    switch(norm)
+    {
+        case L1_NORM:
+            return l1_distance(a, b, n, bound);
+        case L2_NORM:
+            return l2_distance(a, b, n, bound);
+        case LINF_NORM:
+            return linf_distance(a, b, n, bound);
+        default:
+            return p_distance(a, b, n, p, bound);
+    }
+}
+
+#endif
@@ -0,0 +1,274 @@
+#ifndef REDM_FORECAST_MACHINE_H
+#define REDM_FORECAST_MACHINE_H
+
+#include <iostream>
+#include <vector>
+#include <numeric>
+#include <thread>
+#include <stdexcept>
+#include <algorithm>
+#include <functional>
+#include <math.h>
+#include <limits>
+#include <Eigen/Dense>
+#include "data_types.h"
+#include "distance.h"
+#include "profile.h"
+#include "warning_log.h"
+#include "rp_forest.h"
+#include "pivot_index.h"
+#include "pred_scratch.h"
+
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+// constants for the forecasting engine; a class template so that the 
+// definitions can be in this header
+template <typename T>
+struct ForecastConstants
+{
+    static const double qnan;
+    static const double qinf;
+    static const double min_weight;
+};
+
+template <typename T>
+const double ForecastConstants<T>::qnan = std::numeric_limits<double>::quiet_NaN();
+template <typename T>
+const double ForecastConstants<T>::qinf = std::numeric_limits<double>::infinity();
+template <typename T>
+const double ForecastConstants<T>::min_weight = 0.000001;
+
+// a row of the distance matrix, which is stored as float in single 
+// precision mode; entries are read as double either way, and the neighbor 
+// searches dispatch once per row to a loop over the stored type
+class DistanceRow
+{
+public:
+    DistanceRow(const vec& row): double_row(row.data()), float_row(NULL) {}
+    DistanceRow(const fvec& row): double_row(NULL), float_row(row.data()) {}
+    
+    double operator[](const size_t i) const
+    {
+        return double_row ? double_row[i] : double(float_row[i]);
+    }
+    
+    bool is_single() const
+    {
+        return double_row == NULL;
+    }
+    
+    const double* doubles() const
+    {
+        return double_row;
+    }
+    
+    const float* floats() const
+    {
+        return float_row;
+    }
+    
+private:
+    const double* double_row;
+    const float* float_row;
+};
+
+// the forecasting engine has no dependencies on R, so that it can be used 
+// from other C++ code and packages (see rEDM.h); the R bindings are in the 
+// src/*_module.cpp files
+class ForecastMachine: protected ForecastConstants<void>
+{
+public:
+    // called once at the end of each run, with a summary of the warnings 
+    // raised during it (see WarningLog), unless warnings are suppressed; by 
+    // default, warnings are discarded
+    typedef std::function<void (const char*)> WarningHandler;
+    void set_warning_handler(WarningHandler handler);
+    
+    // phase timers and counters (see profile.h), off by default; with 
+    // trace, each timed phase is also kept for ForecastProfile::trace_json()
+    void enable_profiling(const bool trace);
+    void disable_profiling();
+    void reset_profile();
+    const ForecastProfile& get_profile() const;
+    
+    // approximate nearest neighbors from a random projection forest over the 
+    // lib, examining at least search_k candidate lib vectors per prediction 
+    // (0 for exact search); the distance matrix is not stored, so memory is 
+    // linear in the number of vectors. The recall against exact search, on 
+    // a sample of predictions, is measured on each forecast; the seed sets 
+    // the random projections of the forest
+    void set_approximate_neighbors(const size_t search_k, const size_t num_trees, 
+                                   const unsigned long seed);
+    double get_approx_recall() const;
+    
+    // exact nearest neighbors from a pivot index over the lib (0 pivots to 
+    // turn it off): lib vectors whose distance bounds from the pivots rule 
+    // them out are not evaluated, and the distance matrix is not stored. 
+    // Where the bounds don't prune enough to pay for themselves (high E, or 
+    // p < 1, which is not a metric), the lib is scanned instead. Approximate 
+    // neighbors take precedence over this
+    void set_pivot_index(const size_t num_pivots);
+    
+    // single precision mode stores the distance matrix, and a copy of the 
+    // vectors that distances are computed from, as float; weights, S-map 
+    // solves and statistics are still computed in double
+    void set_single_precision(const bool single);
+    
+protected:
+    // *** constructors *** //
+    ForecastMachine();
+    
+    // *** computational methods *** //
+    void init_distances();
+    void compute_distances();
+    //void sort_neighbors();
+    void find_nearest_neighbors(const DistanceRow& dist, const size_t curr_pred, 
+                                std::vector<size_t>& nearest_neighbors, PredScratch& scratch);
+    void find_pred_neighbors(const size_t curr_pred, std::vector<size_t>& nearest_neighbors, 
+                             PredScratch& scratch);
+    DistanceRow distance_row(const size_t curr_pred) const;
+    DistanceRow pred_distances(const size_t curr_pred, const PredScratch& scratch) const;
+    double vector_distance(const size_t i, const size_t j, const double bound = qinf) const;
+    void insert_neighbor(std::vector<size_t>& nearest_neighbors, const DistanceRow& dist, 
+                         const size_t curr_lib);
+    void simplex_weights(const size_t curr_pred, const std::vector<size_t>& nearest_neighbors, 
+                         PredScratch& scratch);
+    void simplex_estimate(const size_t curr_pred, const std::vector<size_t>& nearest_neighbors, 
+                          PredScratch& scratch);
+
+    void forecast();
+    void set_indices_from_range(std::vector<bool>& indices, const std::vector<time_range>& range, 
+                                int start_shift, int end_shift, bool check_target);
+    void set_pred_requested_indices_from_range(std::vector<bool>& indices, 
+                                               const std::vector<time_range>);
+    void check_cross_validation();
+    bool is_vec_valid(const size_t vec_index);
+    bool is_target_valid(const size_t vec_index);
+    bool is_lib_excluded(const size_t curr_pred, const size_t curr_lib);
+    PredStats make_stats();
+    PredStats make_const_stats();
+    size_t count_output_rows();
+    void write_output(double* time, double* obs, double* pred, double* pred_var);
+    std::vector<vec> make_smap_coefficients_output();
+    PackedCovariances make_smap_coefficient_covariances_output();
+    void require_distance_matrix(const char* mode);
+    void reset_approx_recall();
+    void LOG_WARNING(const char* warning_text);
+    void flush_warnings();
+    ForecastProfile* profiler();
+    
+    // *** variables *** //
+    std::vector<bool> lib_indices;
+    std::vector<bool> pred_indices;
+    std::vector<bool> pred_requested_indices;
+    std::vector<size_t> which_lib;
+    std::vector<size_t> which_pred;
+    
+    vec time;
+    vec target_time;
+    std::vector<vec> data_vectors;
+    std::vector<vec> smap_coefficients;
+    PackedCovariances smap_coefficient_covariances; // one per vector
+    vec targets;
+    vec predicted;
+    vec predicted_var;
+    vec const_targets;
+    vec const_predicted;
+    size_t num_vectors;
+    std::function<double (const vec&, const vec&)> dist_func;
+    std::vector<vec > distances;
+    std::vector<fvec> float_distances;
+    
+    // *** parameters *** //
+    bool CROSS_VALIDATION;
+    bool SUPPRESS_WARNINGS;
+    bool SAVE_SMAP_COEFFICIENTS;
+    PredEnum pred_mode;
+    NormEnum norm_mode;
+    size_t nn;
+    double theta;
+    double exclusion_radius;
+    double epsilon;
+    double p;
+    std::vector<time_range> lib_ranges;
+    std::vector<time_range> pred_ranges;
+    WarningHandler warning_handler;
+    WarningLog warning_log;
+    bool PROFILING;
+    ForecastProfile profile;
+    
+    // *** approximate neighbors *** //
+    bool APPROXIMATE_NEIGHBORS;
+    size_t approx_search_k;
+    size_t approx_num_trees;
+    unsigned long approx_seed;
+    size_t approx_recall_hits;
+    size_t approx_recall_total;
+    
+    // *** pivot index *** //
+    // EPSILON_INDEX is set by models that read each row of the distance 
+    // matrix only once, so that their range queries (epsilon >= 0) go 
+    // through a pivot index even if none was requested
+    bool PIVOT_INDEX;
+    size_t pivot_count;
+    bool EPSILON_INDEX;
+    
+    // *** single precision: vectors packed row-major, float_dim per row *** //
+    bool SINGLE_PRECISION;
+    std::vector<float> float_vectors;
+    size_t float_dim;
+    
+    // *** work space for the pred loops (one worker) *** //
+    PredScratch pred_scratch;
+    
+private:
+    // *** methods *** //
+    void simplex_forecast();
+    void smap_forecast();
+    void simplex_prediction(const size_t start, const size_t end, PredScratch& scratch);
+    void smap_prediction(const size_t start, const size_t end, PredScratch& scratch);
+    void smap_lib_prediction(const size_t start, const size_t end, PredScratch& scratch);
+    void const_prediction(const size_t start, const size_t end);
+    template <typename T>
+    void find_nearest_neighbors(const T* dist, const size_t curr_pred, 
+                                std::vector<size_t>& nearest_neighbors, PredScratch& scratch);
+    template <typename T>
+    void insert_neighbor(std::vector<size_t>& nearest_neighbors, const T* dist, 
+                         const size_t curr_lib);
+    void allocate_distances();
+    void pack_float_vectors();
+    float float_distance(const size_t i, const size_t j, const double bound) const;
+    double neighbor_bound(const std::vector<size_t>& nearest_neighbors, const vec& dist) const;
+    bool uses_pivot_index() const;
+    bool stores_distances() const;
+    void build_neighbor_index();
+    void clear_pred_distances(PredScratch& scratch);
+    void examine_candidate(const size_t curr_pred, const size_t curr_lib, 
+                           std::vector<size_t>& nearest_neighbors, PredScratch& scratch, 
+                           size_t& num_abandoned);
+    void find_approx_neighbors(const size_t curr_pred, std::vector<size_t>& nearest_neighbors, 
+                               PredScratch& scratch);
+    void find_indexed_neighbors(const size_t curr_pred, std::vector<size_t>& nearest_neighbors, 
+                                PredScratch& scratch);
+    void measure_approx_recall();
+    
+    // *** neighbor indices *** //
+    RPForest approx_index;
+    PivotIndex pivot_index;
+    bool pivot_scan; // the index is not paying for itself
+    size_t pivot_queries;
+    double pivot_cost;
+    
+    //int num_threads;
+};
+
+std::vector<size_t> which_indices_true(const std::vector<bool>& indices);
+void sort_indices(const DistanceRow& v, std::vector<size_t>& idx);
+template <typename T>
+void sort_indices(const T* v, std::vector<size_t>& idx);
+PredStats compute_stats_internal(const vec& obs, const vec& pred);
+
+#include "forecast_machine_impl.h"
+
+#endif
@@ -0,0 +1,1428 @@
+#ifndef REDM_FORECAST_MACHINE_IMPL_H
+#define REDM_FORECAST_MACHINE_IMPL_H
+
+// definitions for forecast_machine.h, which includes this file; all of them are 
+// inline, so that other packages can use the engine from the headers alone
+
+inline ForecastMachine::ForecastMachine():
+lib_indices(std::vector<bool>()), pred_indices(std::vector<bool>()),
+pred_requested_indices(std::vector<bool>()), 
+which_lib(std::vector<size_t>()), which_pred(std::vector<size_t>()),
+time(vec()), data_vectors(std::vector<vec>()), smap_coefficients(std::vector<vec>()),
+targets(vec()), predicted(vec()), predicted_var(vec()),
+const_targets(vec()), const_predicted(vec()),
+num_vectors(0), distances(std::vector<vec>()),
+CROSS_VALIDATION(false), SUPPRESS_WARNINGS(false), SAVE_SMAP_COEFFICIENTS(false),
+pred_mode(SIMPLEX), norm_mode(L2_NORM),
+nn(0), exclusion_radius(-1), epsilon(-1), p(0.5),
+lib_ranges(std::vector<time_range>()), pred_ranges(std::vector<time_range>()), 
+PROFILING(false), APPROXIMATE_NEIGHBORS(false), approx_search_k(0), approx_num_trees(0), 
+approx_seed(0), approx_recall_hits(0), approx_recall_total(0), PIVOT_INDEX(false), 
+pivot_count(0), EPSILON_INDEX(false), SINGLE_PRECISION(false), float_dim(0), pivot_scan(false), 
+pivot_queries(0), pivot_cost(0)
+{
+    //num_threads = std::thread::hardware_concurrency();
+}
+
+/*
+void ForecastMachine::debug_print_vectors()
+{
+    size_t i = 0;
+    for(auto& v: data_vectors)
+    {
+        std::cerr << i << ": <";
+        for(auto& i: v)
+        {
+            std::cerr << i << " ";
+        }
+        std::cerr << "> --> " << targets[i] << "\n";
+        ++i;
+    }
+    return;
+}
+
+void ForecastMachine::debug_print_lib_and_pred()
+{
+    size_t i = 0;
+    for(auto l: lib_indices)
+    {
+        std::cerr << i << ": " << "lib = " << l << ", pred = " << pred_indices[i] << "\n";
+        ++i;
+    }
+    return;
+}
+*/
+
+inline void ForecastMachine::init_distances()
+{
+    // select distance function
+    switch(norm_mode)
+    {
+        case L1_NORM:
+            dist_func = [](const vec& A, const vec& B)
+            {
+                return l1_distance(A.data(), B.data(), A.size());
+            };
+            break;
+        case L2_NORM:
+            dist_func = [](const vec& A, const vec& B)
+            {
+                return l2_distance(A.data(), B.data(), A.size());
+            };
+            break;
+        case P_NORM:
+            dist_func = [&](const vec& A, const vec& B)
+            {
+                return p_distance(A.data(), B.data(), A.size(), p);
+            };
+            break;
+        case LINF_NORM:
+            dist_func = [](const vec& A, const vec& B)
+            {
+                return linf_distance(A.data(), B.data(), A.size());
+            };
+            break;
+        default:
+            throw std::domain_error("Unknown norm type");
+    }
+
+    // distance matrix is allocated when it is first needed
+    distances.clear();
+    float_distances.clear();
+    return;
+}
+
+inline void ForecastMachine::compute_distances()
+{
+    if(!stores_distances())
+        return;
+    if((SINGLE_PRECISION ? float_distances.size() : distances.size()) != num_vectors)
+        allocate_distances();
+    PhaseTimer timer(profiler(), PHASE_COMPUTE_DISTANCES);
+    size_t num_evaluations = 0;
+    
+    if(SINGLE_PRECISION)
+    {
+        pack_float_vectors();
+        for(auto& curr_pred: which_pred)
+        {
+            fvec& row = float_distances[curr_pred];
+            for(auto& curr_lib: which_lib)
+            {
+                if(std::isnan(row[curr_lib]))
+                {
+                    row[curr_lib] = float_distance(curr_pred, curr_lib, qinf);
+                    float_distances[curr_lib][curr_pred] = row[curr_lib];
+                    ++num_evaluations;
+                }
+            }
+        }
+        if(PROFILING)
+            profile.distance_evaluations += num_evaluations;
+        return;
+    }
+    
+    /*
+    size_t rows = which_pred.size() / num_threads;
+    size_t extra = which_pred.size() % num_threads;
+    size_t start = 0;
+    size_t end = rows;
+
+    std::vector<std::thread> workers;
+    for(int t = 1; t <= num_threads; ++t)
+    {
+        if(t == num_threads)
+            end += extra;
+
+        // set up calculations to be done
+        workers.push_back(std::thread([start, end, this]()
+                                 {
+                                     size_t curr_pred;
+                                     for(size_t i = start; i < end; ++i)
+                                     {
+                                         curr_pred = which_pred[i];
+    */
+    for(auto& curr_pred: which_pred)
+    {
+        for(auto& curr_lib: which_lib)
+        {
+            if(std::isnan(distances[curr_pred][curr_lib]))
+            {
+                distances[curr_pred][curr_lib] = dist_func(data_vectors[curr_pred],
+                                                            data_vectors[curr_lib]);
+                distances[curr_lib][curr_pred] = distances[curr_pred][curr_lib];
+                ++num_evaluations;
+            }
+        }
+    }
+    /*
+                                }));
+
+        // set up rows for next calc
+        start = end;
+        end = start + rows;
+    }
+
+    for(auto& tt: workers)
+        tt.join();
+    */
+    if(PROFILING)
+        profile.distance_evaluations += num_evaluations;
+    return;
+}
+
+inline void ForecastMachine::find_nearest_neighbors(const DistanceRow& dist, const size_t curr_pred, 
+                                                    std::vector<size_t>& nearest_neighbors, 
+                                                    PredScratch& scratch)
+{
+    if(dist.is_single())
+        find_nearest_neighbors(dist.floats(), curr_pred, nearest_neighbors, scratch);
+    else
+        find_nearest_neighbors(dist.doubles(), curr_pred, nearest_neighbors, scratch);
+    return;
+}
+
+inline void ForecastMachine::insert_neighbor(std::vector<size_t>& nearest_neighbors, 
+                                             const DistanceRow& dist, const size_t curr_lib)
+{
+    if(dist.is_single())
+        insert_neighbor(nearest_neighbors, dist.floats(), curr_lib);
+    else
+        insert_neighbor(nearest_neighbors, dist.doubles(), curr_lib);
+    return;
+}
+
+template <typename T>
+inline void ForecastMachine::find_nearest_neighbors(const T* dist, const size_t curr_pred, 
+                                                    std::vector<size_t>& nearest_neighbors, 
+                                                    PredScratch& scratch)
+{
+    if(PROFILING)
+        profile.neighbors_examined += which_lib.size();
+    
+    // lib vectors excluded by cross validation are skipped, and with 
+    // epsilon, only the lib vectors within it are candidates: all of them 
+    // for nn = 0 (a range query), or the nn nearest of them
+    bool filter = (CROSS_VALIDATION || epsilon >= 0);
+    if(filter)
+    {
+        scratch.candidates.clear();
+        for(auto curr_lib: which_lib)
+        {
+            if(CROSS_VALIDATION && is_lib_excluded(curr_pred, curr_lib))
+                continue;
+            if(epsilon >= 0 && dist[curr_lib] > epsilon)
+                continue;
+            scratch.candidates.push_back(curr_lib);
+        }
+    }
+    const std::vector<size_t>& candidates = filter ? scratch.candidates : which_lib;
+    nearest_neighbors.clear();
+    if(nn < 1)
+    {
+        nearest_neighbors.assign(candidates.begin(), candidates.end());
+        sort_indices(dist, nearest_neighbors);
+        return;
+    }
+    // else
+    if(nn > log(double(candidates.size())))
+    {
+        // sort, and keep the nearest nn with any ties for the last
+        nearest_neighbors.assign(candidates.begin(), candidates.end());
+        sort_indices(dist, nearest_neighbors);
+        if(nearest_neighbors.size() <= nn)
+            return;
+        
+        double tie_distance = dist[nearest_neighbors[nn-1]];
+        size_t num_neighbors = nn;
+        while(num_neighbors < nearest_neighbors.size() && 
+              dist[nearest_neighbors[num_neighbors]] <= tie_distance)
+            ++num_neighbors;
+        nearest_neighbors.resize(num_neighbors);
+    }
+    else
+    {
+        for(auto curr_lib: candidates)
+        {
+            insert_neighbor(nearest_neighbors, dist, curr_lib);
+        }
+    }
+    return;
+}
+
+template <typename T>
+inline void ForecastMachine::insert_neighbor(std::vector<size_t>& nearest_neighbors, 
+                                             const T* dist, const size_t curr_lib)
+{
+    // distance to current neighbor under examination
+    double curr_distance = dist[curr_lib];
+    size_t i;
+    
+    // We want to include the current neighbor:
+    //   if haven't populated neighbors vector, or
+    //   if current neighbor is nearer than farthest away neighbor
+    if(nearest_neighbors.size() < nn || 
+       curr_distance <= dist[nearest_neighbors.back()])
+    {
+        // find the correct place to insert the current neighbor
+        i = nearest_neighbors.size();
+        while((i > 0) && (curr_distance < dist[nearest_neighbors[i-1]]))
+        {
+            i--;
+        }
+        nearest_neighbors.insert(nearest_neighbors.begin()+i, curr_lib);
+        
+        // if we've added too many neighbors and there isn't a tie, then
+        // pop off the farthest neighbor
+        while((nearest_neighbors.size() > nn) &&
+              (dist[nearest_neighbors[nn-1]] < dist[nearest_neighbors.back()]))
+        {
+            nearest_neighbors.pop_back();
+        }
+    }
+    return;
+}
+
+inline void ForecastMachine::find_pred_neighbors(const size_t curr_pred, 
+                                                 std::vector<size_t>& nearest_neighbors, 
+                                                 PredScratch& scratch)
+{
+    PhaseTimer timer(profiler(), PHASE_NEIGHBORS);
+    if(APPROXIMATE_NEIGHBORS)
+        find_approx_neighbors(curr_pred, nearest_neighbors, scratch);
+    else if(uses_pivot_index())
+        find_indexed_neighbors(curr_pred, nearest_neighbors, scratch);
+    else
+        find_nearest_neighbors(distance_row(curr_pred), curr_pred, nearest_neighbors, scratch);
+    return;
+}
+
+inline void ForecastMachine::simplex_weights(const size_t curr_pred, 
+                                      const std::vector<size_t>& nearest_neighbors, 
+                                      PredScratch& scratch)
+{
+    size_t effective_nn = nearest_neighbors.size();
+    size_t num_ties;
+    double min_distance, tie_distance, tie_adj_factor;
+    DistanceRow dist = pred_distances(curr_pred, scratch);
+    vec& weights = scratch.weights;
+    
+    min_distance = dist[nearest_neighbors[0]];
+    weights.assign(effective_nn, min_weight);
+    if(min_distance == 0)
+    {
+        for(size_t k = 0; k < effective_nn; ++k)
+        {
+            if(dist[nearest_neighbors[k]] == min_distance)
+                weights[k] = 1;
+            else
+                break;
+        }
+    }
+    else
+    {
+        for(size_t k = 0; k < effective_nn; ++k)
+        {
+            weights[k] = fmax(exp(-dist[nearest_neighbors[k]] / min_distance),
+                              min_weight);
+        }
+    }
+    
+    // identify ties and adjust weights
+    if(effective_nn > nn) // ties exist
+    {
+        tie_distance = dist[nearest_neighbors.back()];
+        
+        // count ties
+        num_ties = 0;
+        for(auto& neighbor_index: nearest_neighbors)
+        {
+            if(dist[neighbor_index] == tie_distance)
+                num_ties++;
+        }
+        
+        tie_adj_factor = double(num_ties + nn - effective_nn) / double(num_ties);
+        
+        // adjust weights
+        for(size_t k = 0; k < effective_nn; ++k)
+        {
+            if(dist[nearest_neighbors[k]] == tie_distance)
+                weights[k] *= tie_adj_factor;
+        }
+    }
+    return;
+}
+
+inline void ForecastMachine::forecast()
+{
+    predicted.assign(num_vectors, qnan); // initialize predictions
+    const_predicted.assign(num_vectors, qnan);
+    predicted_var.assign(num_vectors, qnan);
+    switch(pred_mode)
+    {
+        case SIMPLEX:
+            simplex_forecast();
+            break;
+        case SMAP:
+            smap_forecast();
+            break;
+        default:
+            throw std::domain_error("Unknown pred type");
+    }
+    return;
+}
+
+inline void ForecastMachine::set_indices_from_range(std::vector<bool>& indices, const std::vector<time_range>& range,
+                                             int start_shift, int end_shift, bool check_target)
+{
+    size_t start_of_range, end_of_range;
+    indices.assign(num_vectors, false); // initialize indices
+    for(auto& range_iter: range)
+    {
+        if(start_shift < 0) // check beginning of range
+        {
+            LOG_WARNING("adjustment to beginning of ts was < 0; corrected");
+            start_shift = 0;
+        }
+        start_of_range = range_iter.first + start_shift;
+        if(start_of_range >= num_vectors) // check start of range
+        {
+            std::ostringstream temp;
+            temp << "start_of_range = ";
+            temp << start_of_range + 1;
+            temp << ", but num_vectors = ";
+            temp << num_vectors;
+            std::string temp_str = temp.str();
+            LOG_WARNING(temp_str.c_str());
+            LOG_WARNING("start of time_range was greater than the number of vectors; skipping");
+            continue;
+        }
+
+        end_of_range = range_iter.second + end_shift;
+        if(end_shift < 0 && range_iter.second < abs(end_shift))
+        {
+            std::ostringstream temp;
+            temp << "end_of_range = ";
+            temp << int(range_iter.second) + end_shift + 1;
+            temp << ", which is not positive; skipping";
+            std::string temp_str = temp.str();
+            LOG_WARNING(temp_str.c_str());
+            continue;
+        }
+        if(end_of_range >= num_vectors) // check end of range
+        {
+            std::ostringstream temp;
+            temp << "end_of_range = ";
+            temp << end_of_range + 1;
+            temp << ", but num_vectors = ";
+            temp << num_vectors;
+            std::string temp_str = temp.str();
+            LOG_WARNING(temp_str.c_str());
+            LOG_WARNING("end of time_range was greater than the number of vectors; corrected");
+            end_of_range = num_vectors-1;
+        }
+
+        for(size_t j = start_of_range; j <= end_of_range; ++j)
+        {
+            if(is_vec_valid(j) && (!check_target || is_target_valid(j)))
+                indices[j] = true;
+        }
+    }
+	return;
+}
+
+inline void ForecastMachine::set_pred_requested_indices_from_range(std::vector<bool>& indices, 
+                                             const std::vector<time_range> range)
+{
+    size_t start_of_range, end_of_range;
+    indices.assign(num_vectors, false); // initialize indices
+    for(auto& range_iter: range)
+    {
+        start_of_range = range_iter.first;
+        if(start_of_range >= num_vectors) // check start of range
+        {
+            std::ostringstream temp;
+            temp << "start_of_range = ";
+            temp << start_of_range + 1;
+            temp << ", but num_vectors = ";
+            temp << num_vectors;
+            std::string temp_str = temp.str();
+            LOG_WARNING(temp_str.c_str());
+            LOG_WARNING("start of time_range was greater than the number of vectors; skipping");
+            continue;
+        }
+        
+        end_of_range = range_iter.second;
+        if(end_of_range >= num_vectors) // check end of range
+        {
+            std::ostringstream temp;
+            temp << "end_of_range = ";
+            temp << end_of_range + 1;
+            temp << ", but num_vectors = ";
+            temp << num_vectors;
+            std::string temp_str = temp.str();
+            LOG_WARNING(temp_str.c_str());
+            LOG_WARNING("end of time_range was greater than the number of vectors; corrected");
+            end_of_range = num_vectors-1;
+        }
+        for(size_t j = start_of_range; j <= end_of_range; ++j)
+        {
+            indices[j] = true;
+        }
+    }
+    return;
+}
+inline void ForecastMachine::check_cross_validation()
+{
+    if (exclusion_radius >= 0) // if exclusion_radius is set, always do cross_validation
+    {
+        CROSS_VALIDATION = true;
+        return;
+    }
+    // else
+    for (size_t i = 0; i < num_vectors; ++i) // see if lib indices overlap with pred_indices
+    {
+        if(lib_indices[i] && pred_indices[i])
+        {
+            CROSS_VALIDATION = true; // don't change flags, just enable cross-validation to deal with overlaps
+            exclusion_radius = 0; // exclusion_radius < 0 due to above check
+            LOG_WARNING("Found overlap between lib and pred. Enabling cross-validation with exclusion radius = 0.");
+            return;
+        }
+    }
+
+    return;
+}
+
+inline bool ForecastMachine::is_vec_valid(const size_t vec_index)
+{
+    // check data vector
+    for(auto& val: data_vectors[vec_index])
+        if(std::isnan(val)) return false;
+
+    // if all is good, then:
+    return true;
+}
+
+inline bool ForecastMachine::is_target_valid(const size_t vec_index)
+{
+    // check target value
+    if(std::isnan(targets[vec_index])) return false;
+
+    // if all is good, then:
+    return true;
+}
+
+inline bool ForecastMachine::is_lib_excluded(const size_t curr_pred, const size_t curr_lib)
+{
+    // lib vectors removed from the search space when cross-validating
+    if(curr_lib == curr_pred)
+        return true;
+    if(exclusion_radius >= 0)
+        return (time[curr_lib] >= (time[curr_pred] - exclusion_radius)) && 
+            (time[curr_lib] <= (time[curr_pred] + exclusion_radius));
+    return false;
+}
+
+inline PredStats ForecastMachine::make_stats()
+{
+    PhaseTimer timer(profiler(), PHASE_STATS);
+    return compute_stats_internal(targets, predicted);
+}
+
+inline PredStats ForecastMachine::make_const_stats()
+{
+    PhaseTimer timer(profiler(), PHASE_STATS);
+    return compute_stats_internal(targets, const_predicted);
+}
+
+inline size_t ForecastMachine::count_output_rows()
+{
+    return size_t(std::count(pred_requested_indices.begin(), 
+                             pred_requested_indices.end(), true));
+}
+
+// forecasts for the requested pred rows, aligned with the target times; each 
+// column is written to a caller-owned buffer of count_output_rows() values, 
+// so bindings can fill their own vectors without an intermediate copy
+inline void ForecastMachine::write_output(double* time, double* obs, 
+                                          double* pred, double* pred_var)
+{
+    std::vector<size_t> pred_idx = which_indices_true(pred_requested_indices);
+    for(size_t i = 0; i < pred_idx.size(); ++i)
+    {
+        time[i] = target_time[pred_idx[i]];
+        obs[i] = targets[pred_idx[i]];
+        pred[i] = predicted[pred_idx[i]];
+        pred_var[i] = predicted_var[pred_idx[i]];
+    }
+    return;
+}
+
+inline std::vector<vec> ForecastMachine::make_smap_coefficients_output()
+{
+    // one vector per coefficient (c_1, ..., c_E, c_0), over requested pred rows
+    std::vector<size_t> pred_idx = which_indices_true(pred_requested_indices);
+    std::vector<vec> output(smap_coefficients.size());
+    for(size_t j = 0; j < smap_coefficients.size(); ++j)
+    {
+        output[j].assign(pred_idx.size(), qnan);
+        for(size_t i = 0; i < pred_idx.size(); ++i)
+            output[j][i] = smap_coefficients[j][pred_idx[i]];
+    }
+    return output;
+}
+
+inline PackedCovariances ForecastMachine::make_smap_coefficient_covariances_output()
+{
+    std::vector<size_t> pred_idx = which_indices_true(pred_requested_indices);
+    PackedCovariances output;
+    output.dim = smap_coefficient_covariances.dim;
+    size_t packed_size = output.packed_size();
+    output.values.assign(pred_idx.size() * packed_size, qnan);
+    output.computed.assign(pred_idx.size(), false);
+    for(size_t i = 0; i < pred_idx.size(); ++i)
+    {
+        if(pred_idx[i] < smap_coefficient_covariances.size() && 
+           smap_coefficient_covariances.computed[pred_idx[i]])
+        {
+            output.computed[i] = true;
+            const double* cov = smap_coefficient_covariances.matrix(pred_idx[i]);
+            std::copy(cov, cov + packed_size, output.values.begin() + i * packed_size);
+        }
+    }
+    return output;
+}
+
+inline void ForecastMachine::set_warning_handler(WarningHandler handler)
+{
+    warning_handler = handler;
+    return;
+}
+
+inline void ForecastMachine::enable_profiling(const bool trace)
+{
+    if(!PROFILING)
+        profile.reset();
+    PROFILING = true;
+    profile.trace = trace;
+    return;
+}
+
+inline void ForecastMachine::disable_profiling()
+{
+    PROFILING = false;
+    return;
+}
+
+inline void ForecastMachine::reset_profile()
+{
+    profile.reset();
+    return;
+}
+
+inline const ForecastProfile& ForecastMachine::get_profile() const
+{
+    return profile;
+}
+
+inline void ForecastMachine::set_approximate_neighbors(const size_t search_k, 
+                                                      const size_t num_trees, 
+                                                      const unsigned long seed)
+{
+    APPROXIMATE_NEIGHBORS = (search_k > 0);
+    approx_search_k = search_k;
+    approx_num_trees = std::max(num_trees, size_t(1));
+    approx_seed = seed;
+    if(APPROXIMATE_NEIGHBORS)
+        std::vector<vec>().swap(distances); // release the distance matrix
+    return;
+}
+
+inline void ForecastMachine::set_pivot_index(const size_t num_pivots)
+{
+    PIVOT_INDEX = (num_pivots > 0);
+    pivot_count = num_pivots;
+    if(PIVOT_INDEX)
+        std::vector<vec>().swap(distances); // release the distance matrix
+    return;
+}
+
+inline void ForecastMachine::set_single_precision(const bool single)
+{
+    SINGLE_PRECISION = single;
+    
+    // distances are recomputed in the new precision
+    std::vector<vec>().swap(distances);
+    std::vector<fvec>().swap(float_distances);
+    std::vector<float>().swap(float_vectors);
+    return;
+}
+
+inline double ForecastMachine::get_approx_recall() const
+{
+    if(approx_recall_total == 0)
+        return qnan;
+    return double(approx_recall_hits) / double(approx_recall_total);
+}
+
+inline DistanceRow ForecastMachine::distance_row(const size_t curr_pred) const
+{
+    if(SINGLE_PRECISION)
+        return DistanceRow(float_distances[curr_pred]);
+    return DistanceRow(distances[curr_pred]);
+}
+
+inline DistanceRow ForecastMachine::pred_distances(const size_t curr_pred, 
+                                                   const PredScratch& scratch) const
+{
+    // with a neighbor index, only the distances from the last pred searched 
+    // (to its candidates) are kept, in the scratch it was searched with
+    if(!stores_distances())
+        return DistanceRow(scratch.dist);
+    return distance_row(curr_pred);
+}
+
+inline double ForecastMachine::vector_distance(const size_t i, const size_t j, 
+                                              const double bound) const
+{
+    if(SINGLE_PRECISION)
+        return float_distance(i, j, bound);
+    return partial_distance(data_vectors[i].data(), data_vectors[j].data(), 
+                            data_vectors[i].size(), norm_mode, p, bound);
+}
+
+inline void ForecastMachine::require_distance_matrix(const char* mode)
+{
+    if(!stores_distances())
+    {
+        throw std::domain_error(std::string(mode) + 
+                                " is not supported with approximate neighbors or a pivot index");
+    }
+    return;
+}
+
+inline void ForecastMachine::reset_approx_recall()
+{
+    approx_recall_hits = 0;
+    approx_recall_total = 0;
+    return;
+}
+
+inline ForecastProfile* ForecastMachine::profiler()
+{
+    return PROFILING ? &profile : NULL;
+}
+
+inline void ForecastMachine::LOG_WARNING(const char* warning_text)
+{
+    if(PROFILING)
+        profile.warnings += 1;
+    if(!SUPPRESS_WARNINGS)
+        warning_log.add(warning_text);
+    return;
+}
+
+inline void ForecastMachine::flush_warnings()
+{
+    if(!warning_log.empty() && warning_handler)
+        warning_handler(warning_log.summary().c_str());
+    warning_log.clear();
+    return;
+}
+
+// *** PRIVATE METHODS FOR INTERNAL USE ONLY *** //
+
+inline void ForecastMachine::simplex_forecast()
+{
+    /*
+    size_t rows = which_pred.size() / num_threads;
+    size_t extra = which_pred.size() % num_threads;
+    size_t start = 0;
+    size_t end = rows;
+    std::vector<std::thread> workers;
+
+    for(int t = 1; t <= num_threads; ++t)
+    {
+        if(t == num_threads)
+            end += extra;
+
+        // set up calculations to be done
+        workers.push_back(std::thread(&ForecastMachine::simplex_prediction, this, start, end));
+
+        // set up rows for next calc
+        start = end;
+        end = start + rows;
+    }
+
+    // wait for threads to finish
+    for(auto& tt: workers)
+        tt.join();
+    */
+    if(!stores_distances())
+        build_neighbor_index();
+    simplex_prediction(0, which_pred.size(), pred_scratch);
+    const_prediction(0, which_pred.size());
+    if(APPROXIMATE_NEIGHBORS)
+        measure_approx_recall();
+    return;
+}
+
+inline void ForecastMachine::smap_forecast()
+{
+    /*
+    size_t rows = which_pred.size() / num_threads;
+    size_t extra = which_pred.size() % num_threads;
+    size_t start = 0;
+    size_t end = rows;
+    std::vector<std::thread> workers;
+
+    for(int t = 1; t <= num_threads; ++t)
+    {
+        if(t == num_threads)
+            end += extra;
+
+        // set up calculations to be done
+        workers.push_back(std::thread(&ForecastMachine::smap_prediction, this, start, end));
+
+        // set up rows for next calc
+        start = end;
+        end = start + rows;
+    }
+
+    // wait for threads to finish
+    for(auto& tt: workers)
+        tt.join();
+    */
+    if(SAVE_SMAP_COEFFICIENTS)
+    {
+        smap_coefficient_covariances.dim = data_vectors[0].size() + 1;
+        smap_coefficient_covariances.values.assign(
+            num_vectors * smap_coefficient_covariances.packed_size(), qnan);
+        smap_coefficient_covariances.computed.assign(num_vectors, false);
+        smap_coefficients.assign(data_vectors[0].size()+1, vec(num_vectors, qnan));
+    }
+    if(!stores_distances())
+        build_neighbor_index();
+    if(nn < 1 && stores_distances() && !SAVE_SMAP_COEFFICIENTS)
+        smap_lib_prediction(0, which_pred.size(), pred_scratch);
+    else
+        smap_prediction(0, which_pred.size(), pred_scratch);
+    const_prediction(0, which_pred.size());
+    if(APPROXIMATE_NEIGHBORS)
+        measure_approx_recall();
+    return;
+}
+
+inline void ForecastMachine::simplex_prediction(const size_t start, const size_t end, 
+                                                PredScratch& scratch)
+{
+    size_t curr_pred, effective_nn;
+    std::vector<size_t>& nearest_neighbors = scratch.neighbors;
+    
+    for(size_t k = start; k < end; ++k)
+    {
+        curr_pred = which_pred[k];
+        
+        // find nearest neighbors
+        find_pred_neighbors(curr_pred, nearest_neighbors, scratch);
+        effective_nn = nearest_neighbors.size();
+        if(effective_nn == 0)
+        {
+            predicted[curr_pred] = qnan;
+            LOG_WARNING("no nearest neighbors found; using NA for forecast");
+            continue;
+        }
+        
+        simplex_estimate(curr_pred, nearest_neighbors, scratch);
+    }
+    return;
+}
+
+inline void ForecastMachine::simplex_estimate(const size_t curr_pred, 
+                                       const std::vector<size_t>& nearest_neighbors, 
+                                       PredScratch& scratch)
+{
+    size_t effective_nn = nearest_neighbors.size();
+    double total_weight;
+    const vec& weights = scratch.weights;
+    
+    // compute weights
+    simplex_weights(curr_pred, nearest_neighbors, scratch);
+    
+    /* check info on neighbors
+    for(size_t k = 0; k < effective_nn; ++k)
+    {
+        std::cerr << "neighbor " << k+1 << ": " << "\n";
+        std::cerr << "  distance = " << distance_row(curr_pred)[nearest_neighbors[k]] << "\n";
+        std::cerr << "  weight   = " << weights[k] << "\n";
+        std::cerr << "  target   = " << targets[nearest_neighbors[k]] << "\n";
+    }
+    */
+    
+    // make prediction
+    total_weight = accumulate(weights.begin(), weights.end(), 0.0);
+    predicted[curr_pred] = 0;
+    for(size_t k = 0; k < effective_nn; ++k)
+        predicted[curr_pred] += weights[k] * targets[nearest_neighbors[k]];
+    predicted[curr_pred] = predicted[curr_pred] / total_weight;
+    
+    //compute variance
+    predicted_var[curr_pred] = 0;
+    for(size_t k = 0; k < effective_nn; ++k)
+        predicted_var[curr_pred] += weights[k] * pow(targets[nearest_neighbors[k]] - predicted[curr_pred], 2);
+    predicted_var[curr_pred] = predicted_var[curr_pred] / total_weight;
+//    if(predicted_var[curr_pred] == 0)
+//        LOG_WARNING("Zero prediction uncertainty.");
+    return;
+}
+
+inline void ForecastMachine::smap_prediction(const size_t start, const size_t end, 
+                                             PredScratch& scratch)
+{
+    size_t curr_pred, effective_nn, E = data_vectors[0].size();
+    double avg_distance;
+    std::vector<size_t>& nearest_neighbors = scratch.neighbors;
+    vec& weights = scratch.weights;
+    SmapSolver& solver = scratch.smap;
+    
+    for(size_t k = start; k < end; ++k)
+    {
+        curr_pred = which_pred[k];
+        
+        // find nearest neighbors
+        find_pred_neighbors(curr_pred, nearest_neighbors, scratch);
+        effective_nn = nearest_neighbors.size();
+        
+        if(effective_nn == 0)
+        {
+            predicted[curr_pred] = qnan;
+            LOG_WARNING("no nearest neighbors found; using NA for forecast");
+            continue;
+        }
+        weights.assign(effective_nn, 1.0); // default is for theta = 0
+        if(theta > 0.0)
+        {
+            DistanceRow dist = pred_distances(curr_pred, scratch);
+            
+            // compute average distance
+            avg_distance = 0;
+            for(auto& neighbor: nearest_neighbors)
+            {
+                avg_distance += dist[neighbor];
+            }
+            avg_distance /= effective_nn;
+            
+            // compute weights
+            for(size_t i = 0; i < effective_nn; ++i)
+                weights[i] = exp(-theta * dist[nearest_neighbors[i]] / avg_distance);
+        }
+        
+        // solve the weighted system (see SmapSolver)
+        {
+            PhaseTimer timer(profiler(), PHASE_SVD);
+            solver.reset(E, SAVE_SMAP_COEFFICIENTS);
+            for(size_t i = 0; i < effective_nn; ++i)
+                solver.add_row(data_vectors[nearest_neighbors[i]], weights[i], 
+                               targets[nearest_neighbors[i]]);
+            solver.solve();
+        }
+        if(PROFILING)
+            profile.svd_calls += 1;
+        
+        if(SAVE_SMAP_COEFFICIENTS)
+        {
+            for(size_t j = 0; j <= E; ++j)
+                smap_coefficients[j][curr_pred] = solver.get_coefficients()(j);
+            solver.covariance(smap_coefficient_covariances.values.data() + 
+                              curr_pred * smap_coefficient_covariances.packed_size());
+            smap_coefficient_covariances.computed[curr_pred] = true;
+        }
+        // save prediction
+        predicted[curr_pred] = solver.predict(data_vectors[curr_pred]);
+        
+        // compute variance of prediction (using same approach as simplex)
+        predicted_var[curr_pred] = 0;
+        double total_weight = 0;
+        for(size_t k = 0; k < effective_nn; ++k)
+        {
+            total_weight += weights[k];
+            predicted_var[curr_pred] += weights[k] * pow(targets[nearest_neighbors[k]] - predicted[curr_pred], 2);
+        }
+        predicted_var[curr_pred] = predicted_var[curr_pred] / total_weight;
+//        if(predicted_var[curr_pred] == 0)
+//            LOG_WARNING("Zero prediction uncertainty.");
+    }
+    return;
+}
+
+// s-map with every lib vector (or every one within epsilon) as a neighbor: 
+// their order doesn't matter, so they are streamed into the solver without 
+// sorting them. With theta = 0 and the same lib for every pred, the fit is 
+// only computed once.
+inline void ForecastMachine::smap_lib_prediction(const size_t start, const size_t end, 
+                                                 PredScratch& scratch)
+{
+    size_t curr_pred, E = data_vectors[0].size();
+    std::vector<size_t>& neighbors = scratch.neighbors;
+    SmapSolver& solver = scratch.smap;
+    double avg_distance, w, dt, pred;
+    double total_weight = 0, sum_wt = 0, sum_wtt = 0, target_shift = 0;
+    bool same_fit = (theta == 0 && !CROSS_VALIDATION && epsilon < 0);
+    bool have_fit = false;
+    
+    for(size_t k = start; k < end; ++k)
+    {
+        curr_pred = which_pred[k];
+        if(!(same_fit && have_fit))
+        {
+            DistanceRow dist = distance_row(curr_pred);
+            {
+                PhaseTimer timer(profiler(), PHASE_NEIGHBORS);
+                neighbors.clear();
+                for(auto curr_lib: which_lib)
+                {
+                    if(CROSS_VALIDATION && is_lib_excluded(curr_pred, curr_lib))
+                        continue;
+                    if(epsilon >= 0 && dist[curr_lib] > epsilon)
+                        continue;
+                    neighbors.push_back(curr_lib);
+                }
+                if(PROFILING)
+                    profile.neighbors_examined += which_lib.size();
+            }
+            if(neighbors.empty())
+            {
+                predicted[curr_pred] = qnan;
+                LOG_WARNING("no nearest neighbors found; using NA for forecast");
+                continue;
+            }
+            avg_distance = 0;
+            if(theta > 0.0)
+            {
+                for(auto curr_lib: neighbors)
+                    avg_distance += dist[curr_lib];
+                avg_distance /= neighbors.size();
+            }
+            
+            // the weighted sums for the prediction variance are taken about 
+            // one of the targets, so that they don't cancel
+            PhaseTimer timer(profiler(), PHASE_SVD);
+            solver.reset(E, false);
+            total_weight = sum_wt = sum_wtt = 0;
+            target_shift = targets[neighbors[0]];
+            for(auto curr_lib: neighbors)
+            {
+                w = (theta > 0.0) ? exp(-theta * dist[curr_lib] / avg_distance) : 1.0;
+                solver.add_row(data_vectors[curr_lib], w, targets[curr_lib]);
+                dt = targets[curr_lib] - target_shift;
+                total_weight += w;
+                sum_wt += w * dt;
+                sum_wtt += w * dt * dt;
+            }
+            solver.solve();
+            if(PROFILING)
+                profile.svd_calls += 1;
+            have_fit = true;
+        }
+        
+        pred = solver.predict(data_vectors[curr_pred]);
+        predicted[curr_pred] = pred;
+        
+        // variance of prediction, as in smap_prediction
+        dt = pred - target_shift;
+        predicted_var[curr_pred] = std::max(0.0, (sum_wtt - 2 * dt * sum_wt) / total_weight + dt * dt);
+    }
+    return;
+}
+
+inline void ForecastMachine::const_prediction(const size_t start, const size_t end)
+{
+    size_t curr_pred;
+    for(size_t k = start; k < end; ++k)
+    {
+        curr_pred = which_pred[k];
+        const_predicted[curr_pred] = const_targets[curr_pred];
+    }
+    return;
+}
+
+inline void ForecastMachine::allocate_distances()
+{
+    PhaseTimer timer(profiler(), PHASE_INIT_DISTANCES);
+    if(SINGLE_PRECISION)
+    {
+        float_distances.assign(num_vectors, fvec(num_vectors, std::numeric_limits<float>::quiet_NaN()));
+        if(PROFILING)
+            profile.distance_bytes += num_vectors * num_vectors * sizeof(float);
+        return;
+    }
+    distances.assign(num_vectors, vec(num_vectors, qnan));
+    if(PROFILING)
+        profile.distance_bytes += num_vectors * num_vectors * sizeof(double);
+    return;
+}
+
+inline void ForecastMachine::pack_float_vectors()
+{
+    float_dim = data_vectors.empty() ? 0 : data_vectors[0].size();
+    float_vectors.resize(data_vectors.size() * float_dim);
+    for(size_t i = 0; i < data_vectors.size(); ++i)
+    {
+        for(size_t j = 0; j < float_dim; ++j)
+            float_vectors[i * float_dim + j] = float(data_vectors[i][j]);
+    }
+    return;
+}
+
+inline float ForecastMachine::float_distance(const size_t i, const size_t j, 
+                                            const double bound) const
+{
+    return partial_distance(float_vectors.data() + i * float_dim, 
+                            float_vectors.data() + j * float_dim, 
+                            float_dim, norm_mode, p, float(bound));
+}
+
+// distances to lib vectors greater than this can't change the neighbors 
+// found so far, so their evaluation can be abandoned
+inline double ForecastMachine::neighbor_bound(const std::vector<size_t>& nearest_neighbors, 
+                                              const vec& dist) const
+{
+    double bound = qinf;
+    if(nn >= 1 && nearest_neighbors.size() >= nn)
+        bound = dist[nearest_neighbors[nn - 1]];
+    if(epsilon >= 0)
+        bound = std::min(bound, epsilon);
+    return bound;
+}
+
+// a range query only needs the lib vectors within epsilon, which the pivot 
+// index finds without computing the rest of the row
+inline bool ForecastMachine::uses_pivot_index() const
+{
+    return !APPROXIMATE_NEIGHBORS && (PIVOT_INDEX || (EPSILON_INDEX && epsilon >= 0));
+}
+
+// the distance matrix is not stored when neighbors are searched through an 
+// index; distances are then computed per pred, into PredScratch::dist
+inline bool ForecastMachine::stores_distances() const
+{
+    return !APPROXIMATE_NEIGHBORS && !uses_pivot_index();
+}
+
+inline void ForecastMachine::build_neighbor_index()
+{
+    PhaseTimer timer(profiler(), PHASE_NEIGHBORS);
+    pred_scratch.dist.assign(num_vectors, qnan);
+    pred_scratch.dist_set.clear();
+    if(SINGLE_PRECISION)
+        pack_float_vectors();
+    if(PROFILING)
+        profile.distance_bytes += num_vectors * sizeof(double);
+    
+    if(APPROXIMATE_NEIGHBORS)
+    {
+        // with nn = 0 or a small lib, every lib vector is a candidate anyway
+        pred_scratch.seen.assign(which_lib.size(), 0);
+        if(nn >= 1 && approx_search_k < which_lib.size())
+            approx_index.build(data_vectors, which_lib, approx_num_trees, approx_seed);
+        return;
+    }
+    
+    // the bounds need the triangle inequality, which p < 1 doesn't satisfy, 
+    // and with nn = 0 and no epsilon every lib vector is needed anyway
+    pivot_queries = 0;
+    pivot_cost = 0;
+    pivot_scan = ((nn < 1 && epsilon < 0) || (norm_mode == P_NORM && p < 1));
+    if(pivot_scan)
+        return;
+    
+    // distances in single precision are rounded more, so the bounds from 
+    // them are loosened more
+    double tolerance = SINGLE_PRECISION ? 1e-5 : 1e-12;
+    size_t num_evaluations = 0;
+    size_t num_pivots = PIVOT_INDEX ? pivot_count : 8;
+    pivot_index.build(which_lib, num_pivots, tolerance, 
+                      [&](size_t i, size_t j) {
+                          ++num_evaluations;
+                          return vector_distance(i, j);
+                      });
+    if(PROFILING)
+        profile.distance_evaluations += num_evaluations;
+    return;
+}
+
+inline void ForecastMachine::clear_pred_distances(PredScratch& scratch)
+{
+    for(auto curr_lib: scratch.dist_set)
+        scratch.dist[curr_lib] = qnan;
+    scratch.dist_set.clear();
+    return;
+}
+
+// adds curr_lib to the nearest neighbors of curr_pred (unless it is 
+// excluded, or beyond epsilon); its distance is abandoned once it is past 
+// the nn-th nearest so far, or epsilon (which leaves it at infinity)
+inline void ForecastMachine::examine_candidate(const size_t curr_pred, const size_t curr_lib, 
+                                               std::vector<size_t>& nearest_neighbors, 
+                                               PredScratch& scratch, size_t& num_abandoned)
+{
+    if(CROSS_VALIDATION && is_lib_excluded(curr_pred, curr_lib))
+        return;
+    vec& dist = scratch.dist;
+    if(std::isnan(dist[curr_lib]))
+    {
+        dist[curr_lib] = vector_distance(curr_pred, curr_lib, 
+                                         neighbor_bound(nearest_neighbors, dist));
+        scratch.dist_set.push_back(curr_lib);
+        if(std::isinf(dist[curr_lib]))
+            ++num_abandoned;
+    }
+    if(epsilon >= 0 && dist[curr_lib] > epsilon)
+        return;
+    if(nn < 1)
+        nearest_neighbors.push_back(curr_lib);
+    else
+        insert_neighbor(nearest_neighbors, dist, curr_lib);
+    return;
+}
+
+inline void ForecastMachine::find_approx_neighbors(const size_t curr_pred, 
+                                                   std::vector<size_t>& nearest_neighbors, 
+                                                   PredScratch& scratch)
+{
+    // candidates are positions in which_lib
+    std::vector<size_t>& candidates = scratch.candidates;
+    if(nn < 1 || approx_search_k >= which_lib.size())
+    {
+        candidates.resize(which_lib.size());
+        std::iota(candidates.begin(), candidates.end(), 0);
+    }
+    else
+    {
+        approx_index.candidates(data_vectors[curr_pred], approx_search_k, 
+                                candidates, scratch.seen);
+    }
+    
+    clear_pred_distances(scratch);
+    nearest_neighbors.clear();
+    size_t num_abandoned = 0;
+    for(auto pos: candidates)
+        examine_candidate(curr_pred, which_lib[pos], nearest_neighbors, scratch, num_abandoned);
+    if(PROFILING)
+    {
+        profile.neighbors_examined += candidates.size();
+        profile.distance_evaluations += scratch.dist_set.size();
+        profile.distances_abandoned += num_abandoned;
+    }
+    if(nn < 1)
+        sort_indices(scratch.dist.data(), nearest_neighbors);
+    return;
+}
+
+inline void ForecastMachine::find_indexed_neighbors(const size_t curr_pred, 
+                                                    std::vector<size_t>& nearest_neighbors, 
+                                                    PredScratch& scratch)
+{
+    clear_pred_distances(scratch);
+    nearest_neighbors.clear();
+    size_t num_abandoned = 0;
+    size_t num_checked = which_lib.size();
+    size_t num_visited = which_lib.size();
+    size_t num_pivots = 0;
+    if(pivot_scan)
+    {
+        for(auto curr_lib: which_lib)
+            examine_candidate(curr_pred, curr_lib, nearest_neighbors, scratch, num_abandoned);
+    }
+    else
+    {
+        num_pivots = pivot_index.size();
+        pivot_index.query_distances(curr_pred, [this](size_t i, size_t j) {
+            return vector_distance(i, j);
+        }, scratch.pivot_dist);
+        num_visited = 0;
+        num_checked = pivot_index.search(scratch.pivot_dist, [&]() {
+            return neighbor_bound(nearest_neighbors, scratch.dist);
+        }, [&](size_t pos) {
+            ++num_visited;
+            examine_candidate(curr_pred, which_lib[pos], nearest_neighbors, scratch, num_abandoned);
+        });
+        
+        // after a few preds, if the work per pred (the distances to the 
+        // pivots and to the lib vectors that weren't ruled out, and a check 
+        // per pivot for the rest) is more than a scan of the lib would be, 
+        // the index is not used for the rest
+        size_t dim = data_vectors[curr_pred].size();
+        pivot_cost += double((num_pivots + scratch.dist_set.size()) * dim + num_checked * num_pivots);
+        if(++pivot_queries == 32 && pivot_cost > 32.0 * which_lib.size() * dim)
+            pivot_scan = true;
+    }
+    if(PROFILING)
+    {
+        profile.neighbors_examined += num_checked;
+        profile.distance_evaluations += scratch.dist_set.size() + num_pivots;
+        profile.distances_abandoned += num_abandoned;
+        profile.candidates_pruned += which_lib.size() - num_visited;
+    }
+    if(nn < 1)
+        sort_indices(scratch.dist.data(), nearest_neighbors);
+    return;
+}
+
+inline void ForecastMachine::measure_approx_recall()
+{
+    // exact search over the whole lib for a sample of up to 100 preds
+    size_t num_samples = std::min(which_pred.size(), size_t(100));
+    if(nn < 1 || approx_search_k >= which_lib.size() || num_samples == 0)
+        return;
+    
+    PhaseTimer timer(profiler(), PHASE_NEIGHBORS);
+    vec exact_dist(num_vectors, qnan);
+    std::vector<size_t> exact_neighbors, approx_neighbors;
+    size_t curr_pred;
+    for(size_t k = 0; k < num_samples; ++k)
+    {
+        curr_pred = which_pred[k * which_pred.size() / num_samples];
+        find_approx_neighbors(curr_pred, approx_neighbors, pred_scratch);
+        std::sort(approx_neighbors.begin(), approx_neighbors.end());
+        
+        exact_neighbors.clear();
+        for(auto curr_lib: which_lib)
+        {
+            if(CROSS_VALIDATION && is_lib_excluded(curr_pred, curr_lib))
+                continue;
+            exact_dist[curr_lib] = vector_distance(curr_pred, curr_lib, 
+                                                   neighbor_bound(exact_neighbors, exact_dist));
+            if(epsilon >= 0 && exact_dist[curr_lib] > epsilon)
+                continue;
+            insert_neighbor(exact_neighbors, exact_dist, curr_lib);
+        }
+        for(auto neighbor: exact_neighbors)
+        {
+            if(std::binary_search(approx_neighbors.begin(), approx_neighbors.end(), neighbor))
+                ++approx_recall_hits;
+        }
+        approx_recall_total += exact_neighbors.size();
+    }
+    return;
+}
+
+inline std::vector<size_t> which_indices_true(const std::vector<bool>& indices)
+{
+    std::vector<size_t> which;
+    int index = 0;
+    for(std::vector<bool>::const_iterator iter = indices.begin();
+        iter != indices.end(); ++iter, ++index)
+    {
+        if(*iter)
+            which.push_back(index);
+    }
+    return which;
+}
+
+inline void sort_indices(const DistanceRow& v, std::vector<size_t>& idx)
+{
+    if(v.is_single())
+        sort_indices(v.floats(), idx);
+    else
+        sort_indices(v.doubles(), idx);
+    return;
+}
+
+template <typename T>
+inline void sort_indices(const T* v, std::vector<size_t>& idx)
+{
+    sort(idx.begin(), idx.end(),
+         [v](size_t i1, size_t i2) {return v[i1] < v[i2];});
+    return;
+}
+
+// Pearson correlation over the pairs where both values are present, 
+// matching cor(x, y, use = "pairwise") in R, including the NaN returned 
+// for fewer than 2 pairs or zero variance
+inline double pairwise_correlation(const vec& x, const vec& y)
+{
+    size_t n = std::min(x.size(), y.size());
+    size_t num_pairs = 0;
+    long double x_mean = 0, y_mean = 0;
+    for(size_t k = 0; k < n; ++k)
+    {
+        if(!std::isnan(x[k]) && !std::isnan(y[k]))
+        {
+            x_mean += x[k];
+            y_mean += y[k];
+            ++num_pairs;
+        }
+    }
+    if(num_pairs < 2)
+        return std::numeric_limits<double>::quiet_NaN();
+    x_mean /= num_pairs;
+    y_mean /= num_pairs;
+    
+    // second pass to refine the means, as R does
+    long double x_adj = 0, y_adj = 0;
+    for(size_t k = 0; k < n; ++k)
+    {
+        if(!std::isnan(x[k]) && !std::isnan(y[k]))
+        {
+            x_adj += x[k] - x_mean;
+            y_adj += y[k] - y_mean;
+        }
+    }
+    x_mean += x_adj / num_pairs;
+    y_mean += y_adj / num_pairs;
+    
+    long double sxy = 0, sxx = 0, syy = 0;
+    for(size_t k = 0; k < n; ++k)
+    {
+        if(!std::isnan(x[k]) && !std::isnan(y[k]))
+        {
+            sxy += (x[k] - x_mean) * (y[k] - y_mean);
+            sxx += (x[k] - x_mean) * (x[k] - x_mean);
+            syy += (y[k] - y_mean) * (y[k] - y_mean);
+        }
+    }
+    if(sxx == 0 || syy == 0)
+        return std::numeric_limits<double>::quiet_NaN();
+    double r = double(sxy / (sqrtl(sxx) * sqrtl(syy)));
+    return std::max(-1.0, std::min(1.0, r));
+}
+
+inline PredStats compute_stats_internal(const vec& obs, const vec& pred)
+{
+    size_t num_pred = 0;
+    double sum_errors = 0;
+    double sum_squared_errors = 0;
+    size_t same_sign = 0;
+    size_t num_vectors = obs.size();
+    if(pred.size() < num_vectors)
+        num_vectors = pred.size();
+    
+    for(size_t k = 0; k < num_vectors; ++k)
+    {
+        if(!std::isnan(obs[k]) && !std::isnan(pred[k]))
+        {
+            ++ num_pred;
+            sum_errors += fabs(obs[k] - pred[k]);
+            sum_squared_errors += (obs[k] - pred[k]) * (obs[k] - pred[k]);
+            if((obs[k] >= 0 && pred[k] >= 0) ||
+               (obs[k] <= 0 && pred[k] <= 0))
+                ++ same_sign;
+        }
+    }
+    
+    PredStats output;
+    output.num_pred = num_pred;
+    output.rho = pairwise_correlation(obs, pred);
+    output.mae = sum_errors / double(num_pred);
+    output.rmse = sqrt(sum_squared_errors / double(num_pred));
+    output.perc = double(same_sign) / double(num_pred);
+    
+    // upper tail of N(0, 1 / (n - 3)) at the Fisher z-transform of rho
+    double z = atanh(output.rho) * sqrt(double(output.num_pred) - 3);
+    output.p_val = 0.5 * erfc(z / sqrt(2.0));
+    return output;
+}
+
+#endif
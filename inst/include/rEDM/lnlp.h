@@ -1,11 +1,10 @@
-#ifndef LNLP_H
-#define LNLP_H
+#ifndef REDM_LNLP_H
+#define REDM_LNLP_H
 
-#include <Rcpp.h>
 #include "forecast_machine.h"
 
-using namespace Rcpp;
-
+// simplex projection and S-map on lagged coordinates of a single time 
+// series; lib and pred ranges are 0-indexed rows, inclusive at both ends
 class LNLP: public ForecastMachine
 {
 public:
@@ -13,12 +12,12 @@ public:
     LNLP();
     
     // *** methods *** //
-    void set_time(const NumericVector new_time);
-    void set_time_series(const NumericVector data);
+    void set_time(const vec& new_time);
+    void set_time_series(const vec& data);
     void set_norm(const double norm);
     void set_pred_type(const int pred_type);
-    void set_lib(const NumericMatrix lib);
-    void set_pred(const NumericMatrix pred);
+    void set_lib(const std::vector<time_range>& lib);
+    void set_pred(const std::vector<time_range>& pred);
     void set_exclusion_radius(const double new_exclusion_radius);
     void set_epsilon(const double new_epsilon);
     void set_params(const size_t new_E, const size_t new_tau, const int new_tp, const size_t new_nn);
@@ -26,10 +25,12 @@ public:
     void suppress_warnings();
     void save_smap_coefficients();
     void run();
-    DataFrame get_output();
-    DataFrame get_smap_coefficients();
-    List get_smap_coefficient_covariances();
-    DataFrame get_stats();
+    size_t get_output_size();
+    void get_output(double* time, double* obs, double* pred, double* pred_var);
+    std::vector<vec> get_smap_coefficients();
+    PackedCovariances get_smap_coefficient_covariances();
+    PredStats get_stats();
+    PredStats get_const_stats();
     
 private:
     void prepare_forecast();
@@ -45,4 +46,6 @@ private:
     bool remake_ranges;
 };
 
-#endif
\ No newline at end of file
+#include "lnlp_impl.h"
+
+#endif
@@ -0,0 +1,247 @@
+#ifndef REDM_LNLP_IMPL_H
+#define REDM_LNLP_IMPL_H
+
+// definitions for lnlp.h, which includes this file; all of them are 
+// inline, so that other packages can use the engine from the headers alone
+
+/*** Constructors ***/
+inline LNLP::LNLP(): 
+    time_series(vec()), tp(1), E(1), tau(1), 
+    remake_vectors(true), remake_targets(true), remake_ranges(true)
+{
+    EPSILON_INDEX = true;
+}
+
+inline void LNLP::set_time(const vec& new_time)
+{
+    time = new_time;
+    return;
+}
+
+inline void LNLP::set_time_series(const vec& data)
+{
+    time_series = data;
+    num_vectors = time_series.size();
+    init_distances();
+    return;
+}
+
+inline void LNLP::set_norm(const double norm)
+{
+    if(norm == 1)
+    {
+        norm_mode = L1_NORM;
+    } else if (norm == 2) {
+        norm_mode = L2_NORM;
+    } else if (std::isinf(norm)) {
+        norm_mode = LINF_NORM;
+    } else {
+        norm_mode = P_NORM;
+        p = norm;
+    }
+    return;
+}
+
+inline void LNLP::set_pred_type(const int pred_type)
+{
+    switch(pred_type)
+    {
+        case 1:
+            pred_mode = SMAP;
+            break;
+        case 2:
+            pred_mode = SIMPLEX;
+            break;
+        case 3:
+            pred_mode = FAST_LINEAR;
+            break;
+        default:
+            throw(std::domain_error("unknown pred type selected"));
+    }
+    return;
+}
+
+inline void LNLP::set_lib(const std::vector<time_range>& lib)
+{
+    lib_ranges = lib;
+    remake_ranges = true;
+    return;
+}
+
+inline void LNLP::set_pred(const std::vector<time_range>& pred)
+{
+    pred_ranges = pred;
+    remake_ranges = true;
+    return;
+}
+
+inline void LNLP::set_exclusion_radius(const double new_exclusion_radius)
+{
+    exclusion_radius = new_exclusion_radius;
+    if(exclusion_radius >= 0)
+        CROSS_VALIDATION = true;
+    return;
+}
+
+inline void LNLP::set_epsilon(const double new_epsilon)
+{
+    epsilon = new_epsilon;
+    if(epsilon >= 0)
+    {
+        // range queries go through a pivot index (see uses_pivot_index)
+        std::vector<vec>().swap(distances);
+        std::vector<fvec>().swap(float_distances);
+    }
+    return;
+}
+
+inline void LNLP::set_params(const size_t new_E, const size_t new_tau, const int new_tp, const size_t new_nn)
+{
+    if(E != new_E || tau != new_tau)
+        remake_vectors = true;
+    if(tp != new_tp)
+        remake_targets = true;
+    if(remake_vectors || remake_targets)
+        remake_ranges = true;
+    
+    E = new_E;
+    tau = new_tau;
+    tp = new_tp;
+    nn = new_nn;    
+    return;
+}
+
+inline void LNLP::set_theta(const double new_theta)
+{
+    theta = new_theta;
+    return;
+}
+
+inline void LNLP::suppress_warnings()
+{
+    SUPPRESS_WARNINGS = true;
+    return;
+}
+
+inline void LNLP::save_smap_coefficients()
+{
+    SAVE_SMAP_COEFFICIENTS = true;
+    return;
+}
+
+inline void LNLP::run()
+{
+    PhaseTimer timer(profiler(), PHASE_RUN);
+    warning_log.clear();
+    reset_approx_recall();
+    prepare_forecast(); // check parameters
+    forecast(); // forecast code is in forecast_machine
+    flush_warnings();
+    return;
+}
+
+inline size_t LNLP::get_output_size()
+{
+    return count_output_rows();
+}
+
+inline void LNLP::get_output(double* time, double* obs, double* pred, double* pred_var)
+{
+    write_output(time, obs, pred, pred_var);
+    return;
+}
+
+inline std::vector<vec> LNLP::get_smap_coefficients()
+{
+    return make_smap_coefficients_output();
+}
+
+inline PackedCovariances LNLP::get_smap_coefficient_covariances()
+{
+    return make_smap_coefficient_covariances_output();
+}
+
+inline PredStats LNLP::get_stats()
+{
+    return make_stats();
+}
+
+inline PredStats LNLP::get_const_stats()
+{
+    return make_const_stats();
+}
+
+// *** PRIVATE METHODS FOR INTERNAL USE ONLY *** //
+
+inline void LNLP::prepare_forecast()
+{
+    if(remake_vectors)
+    {
+        make_vectors();
+        init_distances();
+    }
+    
+    if(remake_targets)
+        make_targets();
+    
+    if(remake_ranges)
+    {
+        set_indices_from_range(lib_indices, lib_ranges, (E-1)*tau, -std::max(0, tp), true);
+        set_indices_from_range(pred_indices, pred_ranges, (E-1)*tau, -std::max(0, tp), false);
+        set_pred_requested_indices_from_range(pred_requested_indices, pred_ranges);
+
+        check_cross_validation();
+
+        which_lib = which_indices_true(lib_indices);
+        which_pred = which_indices_true(pred_indices);
+        
+        remake_ranges = false;
+    }
+    
+    compute_distances();
+    return;
+}
+
+inline void LNLP::make_vectors()
+{
+    PhaseTimer timer(profiler(), PHASE_MAKE_VECTORS);
+    
+    data_vectors.assign(num_vectors, vec(E, qnan));
+
+    // beginning of lagged vectors cannot lag before start of time series
+    for(size_t i = 0; i < (unsigned int)((E-1)*tau); ++i)
+        for(size_t j = 0; j < (unsigned int)(E); ++j)
+            if(i >= j*tau)
+                data_vectors[i][j] = time_series[i - j * tau];
+    
+    // remaining lagged vectors
+    for(size_t i = (unsigned int)((E-1)*tau); i < num_vectors; ++i)
+        for(size_t j = 0; j < (unsigned int)(E); ++j)
+            data_vectors[i][j] = time_series[i - j * tau];
+            
+    remake_vectors = false;
+    return;
+}
+
+inline void LNLP::make_targets()
+{
+    if(tp >= 0)
+    {
+        targets.assign(time_series.begin()+tp, time_series.end());
+        targets.insert(targets.end(), tp, qnan);
+        target_time.assign(time.begin()+tp, time.end());
+        target_time.insert(target_time.end(), tp, qnan);
+    }
+    else
+    {
+        targets.assign(time_series.begin(), time_series.end()+tp);
+        targets.insert(targets.begin(), -tp, qnan);
+        target_time.assign(time.begin(), time.end()+tp);
+        target_time.insert(target_time.begin(), -tp, qnan);
+    }
+    const_targets = time_series;
+    remake_targets = false;
+    return;
+}
+
+#endif
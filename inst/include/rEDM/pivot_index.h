@@ -0,0 +1,139 @@
+#ifndef REDM_PIVOT_INDEX_H
+#define REDM_PIVOT_INDEX_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <cstddef>
+#include "data_types.h"
+
+// pivot-based metric index (LAESA): the distances from each lib vector to a
+// few pivot vectors are stored, so that by the triangle inequality
+//   d(q, x) >= |d(q, p) - d(x, p)|
+// for every pivot p, which bounds the distance from a query to each lib
+// vector at the cost of only the query-to-pivot distances. This holds for
+// any metric, i.e., for all of the norms with p >= 1. The lib vectors are
+// kept sorted by distance to the first pivot, so that a search visits them
+// outwards from the query's, and stops once the bound from the first pivot
+// alone rules out the rest.
+class PivotIndex
+{
+public:
+    PivotIndex(): tolerance(0), num_pivots(0) {}
+
+    // chooses num_pivots of the lib vectors by farthest-first traversal
+    // (each pivot is the lib vector farthest from the previous ones), and
+    // stores the distances to them; which lists the lib vectors, distance(i,
+    // j) is the distance between vectors i and j, and the bounds are
+    // loosened by new_tolerance (relative), for rounding in distance
+    template <typename Distance>
+    void build(const std::vector<size_t>& which, const size_t new_num_pivots,
+               const double new_tolerance, Distance distance)
+    {
+        size_t n = which.size();
+        tolerance = new_tolerance;
+        num_pivots = std::min(new_num_pivots, n);
+        pivots.clear();
+        std::vector<vec> dist(num_pivots, vec(n));
+        vec nearest_pivot(n, std::numeric_limits<double>::infinity());
+        size_t next = 0;
+        for(size_t k = 0; k < num_pivots; ++k)
+        {
+            pivots.push_back(which[next]);
+            for(size_t pos = 0; pos < n; ++pos)
+            {
+                dist[k][pos] = distance(which[pos], which[next]);
+                nearest_pivot[pos] = std::min(nearest_pivot[pos], dist[k][pos]);
+            }
+            next = std::max_element(nearest_pivot.begin(), nearest_pivot.end()) -
+                nearest_pivot.begin();
+        }
+
+        // sort by distance to the first pivot, with the distances to all of
+        // the pivots in one row per lib vector
+        order.resize(num_pivots > 0 ? n : 0);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return dist[0][a] < dist[0][b];
+        });
+        first_dist.resize(order.size());
+        pivot_dist.resize(order.size() * num_pivots);
+        for(size_t k = 0; k < order.size(); ++k)
+        {
+            first_dist[k] = dist[0][order[k]];
+            for(size_t j = 0; j < num_pivots; ++j)
+                pivot_dist[k * num_pivots + j] = dist[j][order[k]];
+        }
+        return;
+    }
+
+    // distances from vector query to each pivot, for search
+    template <typename Distance>
+    void query_distances(const size_t query, Distance distance, vec& query_dist) const
+    {
+        query_dist.resize(num_pivots);
+        for(size_t j = 0; j < num_pivots; ++j)
+            query_dist[j] = distance(query, pivots[j]);
+        return;
+    }
+
+    // calls visit(pos) for each lib vector (by position in which) that is not
+    // ruled out, by the pivots, from being within bound() of the query;
+    // bound() may shrink as lib vectors are visited. Returns the number of
+    // lib vectors checked against the pivots.
+    template <typename Bound, typename Visit>
+    size_t search(const vec& query_dist, Bound bound, Visit visit) const
+    {
+        if(num_pivots == 0)
+            return 0;
+        double q0 = query_dist[0];
+        size_t hi = std::lower_bound(first_dist.begin(), first_dist.end(), q0) -
+            first_dist.begin();
+        size_t lo = hi;
+        size_t num_checked = 0;
+        while(lo > 0 || hi < order.size())
+        {
+            // the nearer side in distance to the first pivot is next; both
+            // sides are done once its (loosened) bound is past bound()
+            double gap_lo = lo > 0 ? q0 - first_dist[lo - 1] : std::numeric_limits<double>::infinity();
+            double gap_hi = hi < order.size() ? first_dist[hi] - q0 : std::numeric_limits<double>::infinity();
+            double gap = std::min(gap_lo, gap_hi);
+            double limit = bound();
+            if(gap * (1 - tolerance) - 2 * tolerance * q0 > limit)
+                break;
+            size_t k = (gap_lo <= gap_hi) ? --lo : hi++;
+            ++num_checked;
+            if(!ruled_out(k, query_dist, limit))
+                visit(order[k]);
+        }
+        return num_checked;
+    }
+
+    size_t size() const
+    {
+        return num_pivots;
+    }
+
+private:
+    bool ruled_out(const size_t k, const vec& query_dist, const double limit) const
+    {
+        const double* row = pivot_dist.data() + k * num_pivots;
+        for(size_t j = 1; j < num_pivots; ++j)
+        {
+            if(std::fabs(query_dist[j] - row[j]) - tolerance * (query_dist[j] + row[j]) > limit)
+                return true;
+        }
+        return false;
+    }
+
+    double tolerance;
+    size_t num_pivots;
+    std::vector<size_t> pivots;
+    std::vector<size_t> order; // positions, by distance to the first pivot
+    vec first_dist; // distance to the first pivot, in order
+    vec pivot_dist; // distances to the pivots, a row per position in order
+};
+
+#endif
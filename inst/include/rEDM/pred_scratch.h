@@ -0,0 +1,30 @@
+#ifndef REDM_PRED_SCRATCH_H
+#define REDM_PRED_SCRATCH_H
+
+#include <vector>
+#include <cstddef>
+#include "data_types.h"
+#include "smap_solver.h"
+
+// work space for the per-pred loops of a forecast. The buffers keep their
+// capacity between preds and between runs, so that once they have grown to
+// the size of the lib (and E, for s-map), a prediction is made without
+// allocating. A scratch is not shared between threads: each worker needs
+// its own.
+struct PredScratch
+{
+    std::vector<size_t> neighbors; // of the current pred
+    std::vector<size_t> candidates; // lib vectors (or positions) to search
+    vec weights;
+    SmapSolver smap;
+
+    // distances from the current pred when the distance matrix is not
+    // stored: one entry per vector, NaN where not computed, and a list of
+    // the ones that were, to reset them for the next pred
+    vec dist;
+    std::vector<size_t> dist_set;
+    vec pivot_dist; // from the current pred to the pivots
+    std::vector<char> seen; // for RPForest::candidates
+};
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef REDM_PROFILE_H
+#define REDM_PROFILE_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <cstddef>
+
+// phases of a forecast that are timed when profiling is enabled; run
+// contains the others
+enum ProfilePhase
+{
+    PHASE_RUN,
+    PHASE_MAKE_VECTORS,
+    PHASE_INIT_DISTANCES,
+    PHASE_COMPUTE_DISTANCES,
+    PHASE_NEIGHBORS,
+    PHASE_SVD,
+    PHASE_STATS,
+    NUM_PROFILE_PHASES
+};
+
+inline const char* profile_phase_name(const ProfilePhase phase)
+{
+    static const char* names[NUM_PROFILE_PHASES] = {
+        "run", "make_vectors", "init_distances", "compute_distances",
+        "neighbors", "svd", "stats"};
+    return names[phase];
+}
+
+// one timed phase, in microseconds since profiling was enabled
+struct ProfileEvent
+{
+    ProfilePhase phase;
+    double start_us;
+    double duration_us;
+};
+
+// phase timers and counters, accumulated over all runs since profiling was
+// enabled (or reset)
+struct ForecastProfile
+{
+    ForecastProfile()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        for(size_t k = 0; k < NUM_PROFILE_PHASES; ++k)
+        {
+            seconds[k] = 0;
+            calls[k] = 0;
+        }
+        distance_evaluations = 0;
+        distances_abandoned = 0;
+        candidates_pruned = 0;
+        neighbors_examined = 0;
+        svd_calls = 0;
+        warnings = 0;
+        distance_bytes = 0;
+        events.clear();
+        dropped_events = 0;
+        origin = std::chrono::steady_clock::now();
+        return;
+    }
+
+    // Chrome trace event format, for chrome://tracing or Perfetto
+    std::string trace_json() const
+    {
+        std::ostringstream out;
+        out << "{\"traceEvents\": [";
+        for(size_t k = 0; k < events.size(); ++k)
+        {
+            out << (k > 0 ? ",\n" : "\n")
+                << "{\"name\": \"" << profile_phase_name(events[k].phase)
+                << "\", \"cat\": \"rEDM\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, "
+                << "\"ts\": " << events[k].start_us
+                << ", \"dur\": " << events[k].duration_us << "}";
+        }
+        out << "\n], \"displayTimeUnit\": \"ms\", \"otherData\": {\"dropped_events\": "
+            << dropped_events << "}}\n";
+        return out.str();
+    }
+
+    // *** phase timers *** //
+    double seconds[NUM_PROFILE_PHASES];
+    size_t calls[NUM_PROFILE_PHASES];
+
+    // *** counters *** //
+    size_t distance_evaluations;
+    size_t distances_abandoned; // evaluations stopped early by a neighbor bound
+    size_t candidates_pruned; // lib vectors ruled out by a pivot index
+    size_t neighbors_examined;
+    size_t svd_calls;
+    size_t warnings;
+    size_t distance_bytes; // allocated for distance matrices, in total
+
+    // *** trace; events past max_events are counted but not kept *** //
+    bool trace;
+    std::vector<ProfileEvent> events;
+    size_t dropped_events;
+    std::chrono::steady_clock::time_point origin;
+    static const size_t max_events = 1000000;
+};
+
+// times a phase for as long as it is in scope; does nothing if profile is
+// NULL, so that it costs a branch when profiling is off
+class PhaseTimer
+{
+public:
+    PhaseTimer(ForecastProfile* new_profile, const ProfilePhase new_phase):
+        profile(new_profile), phase(new_phase)
+    {
+        if(profile)
+            start = std::chrono::steady_clock::now();
+    }
+
+    ~PhaseTimer()
+    {
+        if(!profile)
+            return;
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        profile->seconds[phase] += std::chrono::duration<double>(end - start).count();
+        profile->calls[phase] += 1;
+        if(!profile->trace)
+            return;
+        if(profile->events.size() >= ForecastProfile::max_events)
+        {
+            profile->dropped_events += 1;
+            return;
+        }
+        ProfileEvent event;
+        event.phase = phase;
+        event.start_us = std::chrono::duration<double, std::micro>(start - profile->origin).count();
+        event.duration_us = std::chrono::duration<double, std::micro>(end - start).count();
+        profile->events.push_back(event);
+        return;
+    }
+
+private:
+    ForecastProfile* profile;
+    ProfilePhase phase;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef REDM_RP_FOREST_H
+#define REDM_RP_FOREST_H
+
+#include <vector>
+#include <queue>
+#include <random>
+#include <limits>
+#include <utility>
+#include <cstddef>
+#include <math.h>
+#include "data_types.h"
+
+// random projection forest (as in Annoy) for approximate nearest neighbor
+// search: each tree splits on the hyperplane halfway between two randomly
+// chosen points, until leaves have at most leaf_size points; a query
+// searches all trees together, best-first by distance to the splits, and
+// stops after collecting a given number of candidates
+class RPForest
+{
+public:
+    RPForest(): leaf_size(16), num_items(0) {}
+
+    // points are referred to by position in which, so that the same point
+    // can appear more than once
+    void build(const std::vector<vec>& points, const std::vector<size_t>& which,
+               const size_t num_trees, const unsigned long seed)
+    {
+        nodes.clear();
+        roots.clear();
+        items.clear();
+        num_items = which.size();
+        if(num_items == 0)
+            return;
+        std::mt19937_64 rng(seed);
+        std::vector<size_t> positions(num_items);
+        for(size_t t = 0; t < std::max(num_trees, size_t(1)); ++t)
+        {
+            for(size_t i = 0; i < num_items; ++i)
+                positions[i] = i;
+            roots.push_back(build_tree(points, which, positions, rng));
+        }
+        return;
+    }
+
+    // positions of at least search_k candidates near x (or all of them),
+    // without repeats; seen must have one (zeroed) entry per position, and
+    // is zeroed again on return
+    void candidates(const vec& x, const size_t search_k, std::vector<size_t>& output,
+                    std::vector<char>& seen) const
+    {
+        output.clear();
+        std::priority_queue<std::pair<double, size_t> > queue;
+        for(auto root: roots)
+            queue.push(std::make_pair(std::numeric_limits<double>::infinity(), root));
+
+        while(!queue.empty() && output.size() < search_k)
+        {
+            double priority = queue.top().first;
+            const Node& node = nodes[queue.top().second];
+            queue.pop();
+            if(node.left < 0) // leaf
+            {
+                for(size_t i = node.begin; i < node.end; ++i)
+                {
+                    if(!seen[items[i]])
+                    {
+                        seen[items[i]] = 1;
+                        output.push_back(items[i]);
+                    }
+                }
+                continue;
+            }
+            double margin = side(node, x);
+            queue.push(std::make_pair(std::min(priority, margin), size_t(node.right)));
+            queue.push(std::make_pair(std::min(priority, -margin), size_t(node.left)));
+        }
+        for(auto pos: output)
+            seen[pos] = 0;
+        return;
+    }
+
+    size_t size() const
+    {
+        return num_items;
+    }
+
+private:
+    struct Node
+    {
+        vec normal;
+        double offset;
+        int left, right; // -1 for leaves
+        size_t begin, end; // items of leaves
+    };
+
+    double side(const Node& node, const vec& x) const
+    {
+        double s = -node.offset;
+        for(size_t j = 0; j < x.size(); ++j)
+            s += node.normal[j] * x[j];
+        return s;
+    }
+
+    size_t build_tree(const std::vector<vec>& points, const std::vector<size_t>& which,
+                      std::vector<size_t>& positions, std::mt19937_64& rng)
+    {
+        // (node, begin, end) of the positions still to be split
+        struct Task
+        {
+            size_t node, begin, end;
+        };
+        size_t root = nodes.size();
+        nodes.push_back(Node());
+        std::vector<Task> stack(1, Task{root, 0, positions.size()});
+        while(!stack.empty())
+        {
+            Task task = stack.back();
+            stack.pop_back();
+            size_t n = task.end - task.begin;
+            size_t mid = task.begin;
+            Node split;
+            split.left = split.right = -1;
+            if(n > leaf_size)
+            {
+                // try a few pairs of points, in case of duplicates
+                for(size_t tries = 0; tries < 5 && (mid == task.begin || mid == task.end); ++tries)
+                {
+                    const vec& a = points[which[positions[task.begin + rng() % n]]];
+                    const vec& b = points[which[positions[task.begin + rng() % n]]];
+                    split.normal.resize(a.size());
+                    split.offset = 0;
+                    for(size_t j = 0; j < a.size(); ++j)
+                    {
+                        split.normal[j] = a[j] - b[j];
+                        split.offset += split.normal[j] * (a[j] + b[j]) / 2;
+                    }
+                    mid = std::partition(positions.begin() + task.begin, positions.begin() + task.end,
+                                         [&](size_t pos) {
+                                             return side(split, points[which[pos]]) <= 0;
+                                         }) - positions.begin();
+                }
+                if(mid == task.begin || mid == task.end) // all equal; split in half
+                {
+                    std::fill(split.normal.begin(), split.normal.end(), 0.0);
+                    split.offset = 0;
+                    mid = task.begin + n / 2;
+                }
+            }
+            if(n <= leaf_size)
+            {
+                Node& leaf = nodes[task.node];
+                leaf.left = leaf.right = -1;
+                leaf.begin = items.size();
+                items.insert(items.end(), positions.begin() + task.begin, positions.begin() + task.end);
+                leaf.end = items.size();
+                continue;
+            }
+            split.left = int(nodes.size());
+            split.right = int(nodes.size() + 1);
+            nodes[task.node] = split;
+            nodes.push_back(Node());
+            nodes.push_back(Node());
+            stack.push_back(Task{size_t(split.left), task.begin, mid});
+            stack.push_back(Task{size_t(split.right), mid, task.end});
+        }
+        return root;
+    }
+
+    size_t leaf_size;
+    size_t num_items;
+    std::vector<Node> nodes;
+    std::vector<size_t> roots;
+    std::vector<size_t> items;
+};
+
+#endif
@@ -0,0 +1,198 @@
+#ifndef REDM_SMAP_SOLVER_H
+#define REDM_SMAP_SOLVER_H
+
+#include <cmath>
+#include <cstddef>
+#include <Eigen/Dense>
+#include "data_types.h"
+
+// the weighted linear fit of an s-map prediction. The rows of the weighted
+// system [w x, w, w t] (for lib vector x, with target t and weight w) are
+// folded into an (E+2) x (E+2) triangular factor [R c; 0 r] (a QR
+// factorization): a block of rows at a time with a Householder QR, and the
+// rows of the last, partial block one at a time with Givens rotations.
+// Only R is then decomposed with an SVD. R has the same singular values as
+// the whole system, so the truncation gives the same fit, without squaring
+// the condition number as normal equations would. The work space depends
+// only on E, so that fits don't allocate once it has been sized.
+class SmapSolver
+{
+public:
+    SmapSolver(): E(0), filled(0), num_rows(0), COVARIANCE(false), sum_w2(0) {}
+
+    // starts a fit over vectors of new_E coordinates; with covariance, what
+    // covariance() needs is kept as well
+    void reset(const size_t new_E, const bool covariance)
+    {
+        if(new_E != E || stack.rows() == 0)
+        {
+            E = new_E;
+            stack.resize(E + 2 + block_rows, E + 2);
+            qr = Eigen::HouseholderQR<Eigen::MatrixXd>(stack.rows(), stack.cols());
+            weighted_stack.resize(E + 1 + block_rows, E + 1);
+            weighted_qr = Eigen::HouseholderQR<Eigen::MatrixXd>(weighted_stack.rows(), 
+                                                                weighted_stack.cols());
+            factor.resize(E + 1, E + 1);
+            weighted_factor.resize(E + 1, E + 1);
+            s_inv.resize(E + 1);
+            temp.resize(E + 1);
+            coefficients.resize(E + 1);
+        }
+        stack.topRows(E + 2).setZero();
+        filled = 0;
+        num_rows = 0;
+        COVARIANCE = covariance;
+        sum_w2 = 0;
+        if(COVARIANCE)
+            weighted_stack.topRows(E + 1).setZero();
+        return;
+    }
+
+    void add_row(const vec& x, const double w, const double target)
+    {
+        Eigen::Index row = E + 2 + filled;
+        for(size_t j = 0; j < E; ++j)
+            stack(row, j) = w * x[j];
+        stack(row, E) = w;
+        stack(row, E + 1) = w * target;
+        if(COVARIANCE)
+        {
+            // the weighted rows are weighted again, for H below
+            sum_w2 += w * w;
+            for(size_t j = 0; j <= E; ++j)
+                weighted_stack(E + 1 + filled, j) = w * stack(row, j);
+        }
+        ++num_rows;
+        if(++filled == block_rows)
+        {
+            fold(stack, qr);
+            if(COVARIANCE)
+                fold(weighted_stack, weighted_qr);
+            filled = 0;
+        }
+        return;
+    }
+
+    // fits the coefficients (one per coordinate, then the constant),
+    // removing singular values less than 1e-5 of the largest
+    void solve()
+    {
+        for(size_t k = 0; k < filled; ++k)
+        {
+            rotate_in(stack, E + 2 + k);
+            if(COVARIANCE)
+                rotate_in(weighted_stack, E + 1 + k);
+        }
+        filled = 0;
+        
+        factor = stack.topLeftCorner(E + 1, E + 1);
+        svd.compute(factor, Eigen::ComputeFullU | Eigen::ComputeFullV);
+        const Eigen::VectorXd& S = svd.singularValues();
+        double max_s = S(0) * 1e-5;
+        for(size_t j = 0; j <= E; ++j)
+            s_inv(j) = (S(j) >= max_s) ? 1 / S(j) : 0;
+        temp.noalias() = svd.matrixU().transpose() * stack.col(E + 1).head(E + 1);
+        temp.array() *= s_inv.array();
+        coefficients.noalias() = svd.matrixV() * temp;
+        return;
+    }
+
+    double predict(const vec& x) const
+    {
+        double pred = 0;
+        for(size_t j = 0; j < E; ++j)
+            pred += coefficients(j) * x[j];
+        return pred + coefficients(E);
+    }
+
+    const Eigen::VectorXd& get_coefficients() const
+    {
+        return coefficients;
+    }
+
+    // covariance of the coefficients from the last solve() (the rows must
+    // have been added with covariance): sigma^2 H H^T, where H is the
+    // pseudoinverse of the weighted system A times the weights W, and
+    // sigma^2 is the weighted mean squared residual. Since pinv(A) =
+    // V S^-2 V^T A^T, H H^T = K^T K for K = R2 V S^-2 V^T, where R2 is the
+    // triangular factor of W A; and the residual is |c - R x|^2 + r^2, so
+    // neither needs the rows again. The upper triangle is written to packed,
+    // row by row (see PackedCovariances).
+    void covariance(double* packed)
+    {
+        temp.noalias() = stack.col(E + 1).head(E + 1) -
+            stack.topLeftCorner(E + 1, E + 1).triangularView<Eigen::Upper>() * coefficients;
+        double r = stack(E + 1, E + 1);
+        double sigma_squared = (temp.squaredNorm() + r * r) / sum_w2;
+        weighted_factor.noalias() = 
+            weighted_stack.topRows(E + 1).triangularView<Eigen::Upper>() * svd.matrixV();
+        weighted_factor *= s_inv.array().square().matrix().asDiagonal();
+        factor.noalias() = weighted_factor * svd.matrixV().transpose();
+        weighted_factor.noalias() = factor.transpose() * factor;
+        for(size_t i = 0; i <= E; ++i)
+        {
+            for(size_t j = i; j <= E; ++j)
+                *packed++ = sigma_squared * weighted_factor(i, j);
+        }
+        return;
+    }
+
+    size_t size() const
+    {
+        return num_rows;
+    }
+
+private:
+    static const size_t block_rows = 64;
+    
+    // the full block of rows below the factor (the top rows of m, as many as 
+    // its columns) is folded into it
+    static void fold(Eigen::MatrixXd& m, Eigen::HouseholderQR<Eigen::MatrixXd>& m_qr)
+    {
+        Eigen::Index n = m.cols();
+        m_qr.compute(m);
+        m.topRows(n) = m_qr.matrixQR().topRows(n).triangularView<Eigen::Upper>();
+        return;
+    }
+    
+    // row k of m (below the factor) is rotated into the factor, with a 
+    // Givens rotation per column
+    static void rotate_in(Eigen::MatrixXd& m, const Eigen::Index k)
+    {
+        Eigen::Index n = m.cols();
+        for(Eigen::Index j = 0; j < n; ++j)
+        {
+            if(m(k, j) == 0)
+                continue;
+            double r = std::sqrt(m(j, j) * m(j, j) + m(k, j) * m(k, j));
+            double c = m(j, j) / r;
+            double s = m(k, j) / r;
+            m(j, j) = r;
+            for(Eigen::Index l = j + 1; l < n; ++l)
+            {
+                double m_jl = m(j, l);
+                m(j, l) = c * m_jl + s * m(k, l);
+                m(k, l) = c * m(k, l) - s * m_jl;
+            }
+        }
+        return;
+    }
+
+    size_t E;
+    size_t filled; // rows stacked below the factor
+    size_t num_rows; // since reset()
+    bool COVARIANCE;
+    double sum_w2;
+    Eigen::MatrixXd stack; // [R c; 0 r], then a block of rows
+    Eigen::HouseholderQR<Eigen::MatrixXd> qr;
+    Eigen::MatrixXd weighted_stack; // R2, then a block of rows of W A
+    Eigen::HouseholderQR<Eigen::MatrixXd> weighted_qr;
+    Eigen::JacobiSVD<Eigen::MatrixXd> svd;
+    Eigen::MatrixXd factor;
+    Eigen::MatrixXd weighted_factor;
+    Eigen::VectorXd s_inv;
+    Eigen::VectorXd temp;
+    Eigen::VectorXd coefficients;
+};
+
+#endif
@@ -0,0 +1,226 @@
+#ifndef REDM_STATS_SUMMARY_H
+#define REDM_STATS_SUMMARY_H
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include "data_types.h"
+
+// a quantile estimated from a stream of values by the P-square algorithm
+// (Jain and Chlamtac 1985): five markers, at the minimum, the p/2, p and
+// (1+p)/2 quantiles, and the maximum, are moved towards their desired
+// positions as values arrive, with a piecewise-parabolic fit for their
+// heights, so that memory does not grow with the number of values. Up to
+// five values, the quantile is exact (as with type 7 of R's quantile()).
+class P2Quantile
+{
+public:
+    P2Quantile(const double new_p = 0.5): p(new_p), count(0) {}
+
+    void add(const double x)
+    {
+        if(count < 5)
+        {
+            // insertion sort into the markers
+            size_t i = count++;
+            for(; i > 0 && heights[i - 1] > x; --i)
+                heights[i] = heights[i - 1];
+            heights[i] = x;
+            if(count == 5)
+            {
+                for(size_t j = 0; j < 5; ++j)
+                    positions[j] = j + 1;
+                desired[0] = 1;
+                desired[1] = 1 + 2 * p;
+                desired[2] = 1 + 4 * p;
+                desired[3] = 3 + 2 * p;
+                desired[4] = 5;
+                increments[0] = 0;
+                increments[1] = p / 2;
+                increments[2] = p;
+                increments[3] = (1 + p) / 2;
+                increments[4] = 1;
+            }
+            return;
+        }
+        ++count;
+
+        // find the cell of x, extending the extremes if need be
+        size_t k;
+        if(x < heights[0])
+        {
+            heights[0] = x;
+            k = 0;
+        }
+        else if(x >= heights[4])
+        {
+            heights[4] = x;
+            k = 3;
+        }
+        else
+        {
+            k = 0;
+            while(x >= heights[k + 1])
+                ++k;
+        }
+        for(size_t i = k + 1; i < 5; ++i)
+            positions[i] += 1;
+        for(size_t i = 0; i < 5; ++i)
+            desired[i] += increments[i];
+
+        // move the middle markers that are off by a position or more
+        for(size_t i = 1; i < 4; ++i)
+        {
+            double d = desired[i] - positions[i];
+            if((d >= 1 && positions[i + 1] - positions[i] > 1) ||
+               (d <= -1 && positions[i - 1] - positions[i] < -1))
+            {
+                d = d > 0 ? 1 : -1;
+                double height = parabolic(i, d);
+                if(heights[i - 1] < height && height < heights[i + 1])
+                    heights[i] = height;
+                else
+                    heights[i] = linear(i, d);
+                positions[i] += d;
+            }
+        }
+        return;
+    }
+
+    double get() const
+    {
+        if(count == 0)
+            return std::numeric_limits<double>::quiet_NaN();
+        if(count >= 5)
+            return heights[2];
+        double h = (count - 1) * p;
+        size_t lo = size_t(h);
+        if(lo + 1 >= count)
+            return heights[lo];
+        return heights[lo] + (h - lo) * (heights[lo + 1] - heights[lo]);
+    }
+
+private:
+    double parabolic(const size_t i, const double d) const
+    {
+        return heights[i] + d / (positions[i + 1] - positions[i - 1]) *
+            ((positions[i] - positions[i - 1] + d) * (heights[i + 1] - heights[i]) /
+                 (positions[i + 1] - positions[i]) +
+             (positions[i + 1] - positions[i] - d) * (heights[i] - heights[i - 1]) /
+                 (positions[i] - positions[i - 1]));
+    }
+
+    double linear(const size_t i, const double d) const
+    {
+        size_t j = d > 0 ? i + 1 : i - 1;
+        return heights[i] + d * (heights[j] - heights[i]) / (positions[j] - positions[i]);
+    }
+
+    double p;
+    size_t count;
+    double heights[5];
+    double positions[5];
+    double desired[5];
+    double increments[5];
+};
+
+// mean and variance (by Welford's algorithm), and the median and a 95% band
+// (see P2Quantile), of a stream of values; NaN values are counted, but left
+// out of the summary
+class RunningSummary
+{
+public:
+    RunningSummary():
+        count(0), num_nan(0), running_mean(0), sum_squares(0),
+        lower_quantile(0.025), median_quantile(0.5), upper_quantile(0.975) {}
+
+    void add(const double x)
+    {
+        if(std::isnan(x))
+        {
+            ++num_nan;
+            return;
+        }
+        ++count;
+        double delta = x - running_mean;
+        running_mean += delta / count;
+        sum_squares += delta * (x - running_mean);
+        lower_quantile.add(x);
+        median_quantile.add(x);
+        upper_quantile.add(x);
+        return;
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    size_t nan_count() const
+    {
+        return num_nan;
+    }
+
+    double mean() const
+    {
+        return count > 0 ? running_mean : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    // sample variance, as var() in R
+    double variance() const
+    {
+        return count > 1 ? sum_squares / (count - 1) : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    double lower() const
+    {
+        return lower_quantile.get();
+    }
+
+    double median() const
+    {
+        return median_quantile.get();
+    }
+
+    double upper() const
+    {
+        return upper_quantile.get();
+    }
+
+private:
+    size_t count;
+    size_t num_nan;
+    double running_mean;
+    double sum_squares; // of differences from the mean
+    P2Quantile lower_quantile;
+    P2Quantile median_quantile;
+    P2Quantile upper_quantile;
+};
+
+// summary of the forecast statistics of all samples at a lib size (and
+// target column)
+struct StatsSummary
+{
+    StatsSummary(const size_t new_lib_size = 0, const size_t new_target_column = 0):
+        lib_size(new_lib_size), target_column(new_target_column), num_samples(0) {}
+
+    void add(const PredStats& stats)
+    {
+        ++num_samples;
+        num_pred.add(double(stats.num_pred));
+        rho.add(stats.rho);
+        mae.add(stats.mae);
+        rmse.add(stats.rmse);
+        return;
+    }
+
+    size_t lib_size;
+    size_t target_column;
+    size_t num_samples;
+    RunningSummary num_pred;
+    RunningSummary rho;
+    RunningSummary mae;
+    RunningSummary rmse;
+};
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef REDM_WARNING_LOG_H
+#define REDM_WARNING_LOG_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <sstream>
+#include <cstddef>
+
+// warnings raised during a run, counted by message in the order each was
+// first raised, so that a run reports one summary instead of a warning per
+// prediction; a log is not shared between threads (each worker keeps its
+// own, and they are merged when the workers finish)
+class WarningLog
+{
+public:
+    typedef std::pair<std::string, size_t> Entry;
+
+    void add(const char* text)
+    {
+        // a run raises only a handful of distinct messages
+        for(auto& entry: entries)
+        {
+            if(entry.first == text)
+            {
+                entry.second += 1;
+                return;
+            }
+        }
+        entries.push_back(Entry(text, 1));
+        return;
+    }
+
+    void merge(const WarningLog& other)
+    {
+        for(auto& other_entry: other.entries)
+        {
+            bool found = false;
+            for(auto& entry: entries)
+            {
+                if(entry.first == other_entry.first)
+                {
+                    entry.second += other_entry.second;
+                    found = true;
+                    break;
+                }
+            }
+            if(!found)
+                entries.push_back(other_entry);
+        }
+        return;
+    }
+
+    void clear()
+    {
+        entries.clear();
+        return;
+    }
+
+    bool empty() const
+    {
+        return entries.empty();
+    }
+
+    const std::vector<Entry>& get_entries() const
+    {
+        return entries;
+    }
+
+    // one line per message, with the count if it was raised more than once
+    std::string summary() const
+    {
+        std::ostringstream out;
+        for(size_t k = 0; k < entries.size(); ++k)
+        {
+            if(k > 0)
+                out << "\n";
+            out << entries[k].first;
+            if(entries[k].second > 1)
+                out << " [" << entries[k].second << " times]";
+        }
+        return out.str();
+    }
+
+private:
+    std::vector<Entry> entries;
+};
+
+#endif
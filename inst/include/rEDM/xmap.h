@@ -0,0 +1,120 @@
+#ifndef REDM_XMAP_H
+#define REDM_XMAP_H
+
+#include <iostream>
+#include <random>
+#include <cstdint>
+#include "forecast_machine.h"
+#include "stats_summary.h"
+
+// convergent cross mapping between columns of a block, given as a vector of 
+// columns; lib and target columns are 1-indexed, and lib and pred ranges 
+// are 0-indexed rows, inclusive at both ends
+class Xmap: public ForecastMachine
+{
+public:
+    // returns a uniform random number in [a, b), as R::runif(a, b)
+    typedef std::function<double (double, double)> UniformGenerator;
+    
+    // *** constructors *** //
+    Xmap();
+    
+    // *** methods *** //
+    void set_time(const vec& time);
+    void set_block(const std::vector<vec>& new_block);
+    void set_norm(const double norm);
+    void set_lib(const std::vector<time_range>& lib);
+    void set_pred(const std::vector<time_range>& pred);
+    void set_lib_sizes(const std::vector<size_t>& new_lib_sizes);
+    void set_exclusion_radius(const double new_exclusion_radius);
+    void set_epsilon(const double new_epsilon);
+    void set_lib_column(const size_t new_lib_col);
+    void set_target_column(const size_t new_target);
+    void set_target_columns(const std::vector<size_t>& new_targets);
+    void set_params(const size_t new_E, const size_t new_tau, const int new_tp, 
+                    const size_t new_nn, const bool new_random_libs, 
+                    const size_t new_num_samples, const bool new_replace);
+    void enable_model_output();
+    void enable_nested_libs();
+    void enable_stats_summary();
+    void set_seed(const unsigned long seed);
+    void set_uniform_generator(UniformGenerator generator);
+    void suppress_warnings();
+    void run();
+    void run_all_targets();
+    std::vector<PredStats> get_stats();
+    std::vector<size_t> get_lib_sizes();
+    std::vector<size_t> get_target_columns();
+    const ModelOutput& get_output() const;
+    const std::vector<StatsSummary>& get_stats_summary() const;
+    
+private:
+    double uniform(const double a, const double b);
+    void prepare_forecast();
+    void make_vectors();
+    void make_targets();
+    void prep_model_output();
+    void save_current_output(const size_t model);
+    void prepare_all_targets();
+    void sample_random_lib(const std::vector<size_t>& full_lib, const size_t lib_size);
+    void find_all_pred_neighbors(std::vector<std::vector<size_t> >& pred_neighbors);
+    void forecast_from_neighbors(const std::vector<std::vector<size_t> >& pred_neighbors);
+    void cross_map_all_targets(const size_t lib_size, 
+                               const std::vector<std::vector<size_t> >& pred_neighbors);
+    bool sorts_window_neighbors(const size_t lib_size, const size_t max_lib_size) const;
+    void find_window_neighbors(const std::vector<size_t>& full_lib, const size_t start, 
+                               const size_t lib_size, 
+                               std::vector<std::vector<size_t> >& pred_neighbors);
+    void sort_lib_positions(const std::vector<size_t>& full_lib);
+    void scan_window_neighbors(const std::vector<size_t>& full_lib, const size_t i, 
+                               const size_t start, const size_t lib_size);
+    void update_window_neighbors(const std::vector<size_t>& full_lib, const size_t start, 
+                                 const size_t lib_size);
+    void get_window_neighbors(const std::vector<size_t>& full_lib, 
+                              std::vector<std::vector<size_t> >& pred_neighbors);
+    std::vector<size_t> sample_nested_lib(const std::vector<size_t>& full_lib, 
+                                          const size_t lib_size);
+    void run_nested_libs(const std::vector<size_t>& full_lib);
+    void record_stats(const PredStats& stats, const size_t lib_size, 
+                      const size_t target_column);
+    
+    // *** local parameters *** //
+    std::vector<vec> block;
+    std::vector<size_t> lib_sizes;
+    int tp;
+    size_t E, tau;
+    size_t lib_col, target;
+    std::vector<size_t> target_columns;
+    std::vector<vec> all_targets;
+    bool random_libs;
+    size_t num_samples;
+    bool replace;
+    bool nested_libs;
+    bool remake_vectors;
+    bool remake_targets;
+    bool remake_ranges;
+    bool save_model_preds;
+    bool summarize_stats;
+    ModelOutput model_output;
+    std::vector<size_t> model_output_rows; // requested pred rows
+    
+    // *** random lib sampling; uses rng unless a generator is given *** //
+    std::mt19937_64 rng;
+    UniformGenerator uniform_generator;
+    
+    // *** contiguous lib neighbors; positions in full_lib, sorted by 
+    // distance from each pred (only for the larger lib sizes) *** //
+    std::vector<std::vector<uint32_t> > sorted_lib_positions;
+    std::vector<std::vector<size_t> > window_positions;
+    
+    // *** output data structures: stats per sample, or summaries per lib 
+    // size and target column *** //
+    std::vector<PredStats> predicted_stats;
+    std::vector<size_t> predicted_lib_sizes;
+    std::vector<size_t> predicted_target_columns;
+    std::vector<StatsSummary> stats_summaries;
+};
+
+#include "xmap_impl.h"
+
+#endif
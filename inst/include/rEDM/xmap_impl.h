@@ -0,0 +1,966 @@
+#ifndef REDM_XMAP_IMPL_H
+#define REDM_XMAP_IMPL_H
+
+// definitions for xmap.h, which includes this file; all of them are 
+// inline, so that other packages can use the engine from the headers alone
+
+/*** Constructors ***/
+inline Xmap::Xmap():
+    block(std::vector<vec>()), lib_sizes(std::vector<size_t>()), tp(0), E(0), 
+    tau(1), lib_col(0), target(0), random_libs(true), num_samples(0), 
+    nested_libs(false), remake_vectors(true), remake_targets(true), remake_ranges(true), 
+    save_model_preds(false), summarize_stats(false)
+{
+    pred_mode = SIMPLEX;
+}
+
+inline void Xmap::set_time(const vec& new_time)
+{
+    time = new_time;
+    return;
+}
+
+inline void Xmap::set_block(const std::vector<vec>& new_block)
+{
+    block = new_block;
+    num_vectors = block.empty() ? 0 : block[0].size();
+    init_distances();
+    return;
+}
+
+inline void Xmap::set_norm(const double norm)
+{
+    if(norm == 1)
+    {
+        norm_mode = L1_NORM;
+    } else if (norm == 2) {
+        norm_mode = L2_NORM;
+    } else if (std::isinf(norm)) {
+        norm_mode = LINF_NORM;
+    } else {
+        norm_mode = P_NORM;
+        p = norm;
+    }
+    return;
+}
+
+inline void Xmap::set_lib(const std::vector<time_range>& lib)
+{
+    lib_ranges = lib;
+    remake_ranges = true;
+    return;
+}
+
+inline void Xmap::set_pred(const std::vector<time_range>& pred)
+{
+    pred_ranges = pred;
+    remake_ranges = true;
+    return;
+}
+
+inline void Xmap::set_lib_sizes(const std::vector<size_t>& new_lib_sizes)
+{
+    // the runs (nested libs in particular) go through the sizes in 
+    // increasing order
+    lib_sizes = new_lib_sizes;
+    std::sort(lib_sizes.begin(), lib_sizes.end());
+    lib_sizes.erase(std::unique(lib_sizes.begin(), lib_sizes.end()), lib_sizes.end());
+    return;
+}
+
+inline void Xmap::set_exclusion_radius(const double new_exclusion_radius)
+{
+    exclusion_radius = new_exclusion_radius;
+    if(exclusion_radius >= 0)
+        CROSS_VALIDATION = true;
+    return;
+}
+
+inline void Xmap::set_epsilon(const double new_epsilon)
+{
+    epsilon = new_epsilon;
+    return;
+}
+
+inline void Xmap::set_lib_column(const size_t new_lib_col)
+{
+    lib_col = new_lib_col;
+    remake_vectors = true;
+    return;
+}
+
+inline void Xmap::set_target_column(const size_t new_target)
+{
+    target = new_target;
+    remake_targets = true;
+    return;
+}
+
+inline void Xmap::set_target_columns(const std::vector<size_t>& new_targets)
+{
+    target_columns = new_targets;
+    return;
+}
+
+inline void Xmap::set_params(const size_t new_E, const size_t new_tau, const int new_tp, 
+                    const size_t new_nn, const bool new_random_libs, 
+                    const size_t new_num_samples, const bool new_replace)
+{
+    if(E != new_E || tau != new_tau)
+        remake_vectors = true;
+    if(tp != new_tp)
+        remake_targets = true;
+    if(remake_vectors || remake_targets)
+        remake_ranges = true;
+    
+    E = new_E;
+    tau = new_tau;
+    tp = new_tp;
+    nn = new_nn;
+    random_libs = new_random_libs;
+    num_samples = new_num_samples;
+    replace = new_replace;
+    
+    return;
+}
+
+inline void Xmap::enable_model_output()
+{
+    save_model_preds = true;
+    return;
+}
+
+inline void Xmap::enable_nested_libs()
+{
+    nested_libs = true;
+    return;
+}
+
+inline void Xmap::enable_stats_summary()
+{
+    summarize_stats = true;
+    return;
+}
+
+inline void Xmap::set_seed(const unsigned long seed)
+{
+    rng.seed(seed);
+    return;
+}
+
+inline void Xmap::set_uniform_generator(UniformGenerator generator)
+{
+    uniform_generator = generator;
+    return;
+}
+
+inline void Xmap::prep_model_output()
+{
+    if (!save_model_preds)
+        return;
+    
+    size_t model_counter = 0;
+    for(auto lib_size: lib_sizes)
+    {
+        if(lib_size >= which_lib.size() && (!random_libs || !replace))
+            // no possible lib variation if using all vectors and
+            // [no random libs OR (random_libs and sampling without replacement)]
+        {
+            model_counter++;
+            break;
+        }
+        else if(random_libs)
+        {
+            for(size_t k = 0; k < num_samples; ++k)
+            {
+                model_counter++;
+            }
+        }
+        else // no random libs and using contiguous segments
+        {
+            for(size_t k = 0; k < which_lib.size(); ++k)
+            {
+                model_counter++;
+            }
+        }
+    }
+    
+    model_output_rows = which_indices_true(pred_requested_indices);
+    size_t num_rows = model_output_rows.size();
+    model_output.num_models = model_counter;
+    model_output.time.resize(num_rows);
+    model_output.obs.resize(num_rows);
+    for(size_t i = 0; i < num_rows; ++i)
+    {
+        model_output.time[i] = target_time[model_output_rows[i]];
+        model_output.obs[i] = targets[model_output_rows[i]];
+    }
+    model_output.pred.assign(model_counter * num_rows, qnan);
+    model_output.pred_var.assign(model_counter * num_rows, qnan);
+    return;
+}
+
+inline void Xmap::save_current_output(const size_t model)
+{
+    // the times and observations are the same for every model in a run
+    size_t offset = model * model_output_rows.size();
+    for(size_t i = 0; i < model_output_rows.size(); ++i)
+    {
+        model_output.pred[offset + i] = predicted[model_output_rows[i]];
+        model_output.pred_var[offset + i] = predicted_var[model_output_rows[i]];
+    }
+    return;
+}
+
+inline void Xmap::suppress_warnings()
+{
+    SUPPRESS_WARNINGS = true;
+    return;
+}
+
+inline void Xmap::run()
+{
+    PhaseTimer timer(profiler(), PHASE_RUN);
+    warning_log.clear();
+    reset_approx_recall();
+    prepare_forecast(); // check parameters
+    prep_model_output();
+    
+    // setup data structures and compute maximum lib size
+    predicted_stats.clear();
+    predicted_lib_sizes.clear();
+    predicted_target_columns.clear();
+    stats_summaries.clear();
+    std::vector<size_t> full_lib = which_lib;
+    size_t max_lib_size = full_lib.size();
+    size_t model_counter = 0;
+    std::vector<std::vector<size_t> > pred_neighbors;
+    sorted_lib_positions.clear();
+    
+    if(random_libs && nested_libs)
+    {
+        if(nn >= 1)
+        {
+            require_distance_matrix("nested libs");
+            run_nested_libs(full_lib);
+            which_lib.swap(full_lib);
+            flush_warnings();
+            return;
+        }
+        LOG_WARNING("nested libs need num_neighbors >= 1; sampling libs independently");
+    }
+
+    for(auto lib_size: lib_sizes)
+    {
+        if(lib_size >= max_lib_size && (!random_libs || !replace))
+        // no possible lib variation if using all vectors and
+        // [no random libs OR (random_libs and sampling without replacement)]
+        {
+            if(lib_size > max_lib_size)
+            {
+                LOG_WARNING("lib size request was larger than maximum available; corrected");
+            }
+            which_lib = full_lib; // use all lib vectors
+            forecast();
+            record_stats(make_stats(), max_lib_size, target);
+            if(save_model_preds)
+            {
+                save_current_output(model_counter);
+                model_counter++;
+            }
+            if(lib_size != lib_sizes.back())
+            {
+                LOG_WARNING("maximum lib size reached; ignoring remainder");
+            }
+            break;
+        }
+        else if(random_libs)
+        {
+            for(size_t k = 0; k < num_samples; ++k)
+            {
+                sample_random_lib(full_lib, lib_size);
+                forecast();
+                record_stats(make_stats(), lib_size, target);
+                if(save_model_preds)
+                {
+                    save_current_output(model_counter);
+                    model_counter++;
+                }
+            }
+        }
+        else
+        // no random libs and using contiguous segments
+        {
+            require_distance_matrix("contiguous libs");
+            for(size_t k = 0; k < max_lib_size; ++k)
+            {
+                find_window_neighbors(full_lib, k, lib_size, pred_neighbors);
+                forecast_from_neighbors(pred_neighbors);
+                record_stats(make_stats(), lib_size, target);
+                if(save_model_preds)
+                {
+                    save_current_output(model_counter);
+                    model_counter++;
+                }
+            }
+        }
+    }
+    which_lib.swap(full_lib);
+    sorted_lib_positions.clear();
+    window_positions.clear();
+    flush_warnings();
+    return;
+}
+
+inline void Xmap::run_all_targets()
+{
+    PhaseTimer timer(profiler(), PHASE_RUN);
+    warning_log.clear();
+    require_distance_matrix("cross mapping all targets");
+    prepare_all_targets(); // check parameters
+    
+    // setup data structures and compute maximum lib size
+    predicted_stats.clear();
+    predicted_lib_sizes.clear();
+    predicted_target_columns.clear();
+    stats_summaries.clear();
+    std::vector<size_t> full_lib = which_lib;
+    size_t max_lib_size = full_lib.size();
+    std::vector<std::vector<size_t> > pred_neighbors;
+    sorted_lib_positions.clear();
+    
+    for(auto lib_size: lib_sizes)
+    {
+        if(lib_size >= max_lib_size && (!random_libs || !replace))
+        // no possible lib variation if using all vectors and
+        // [no random libs OR (random_libs and sampling without replacement)]
+        {
+            if(lib_size > max_lib_size)
+            {
+                LOG_WARNING("lib size request was larger than maximum available; corrected");
+            }
+            which_lib = full_lib; // use all lib vectors
+            find_all_pred_neighbors(pred_neighbors);
+            cross_map_all_targets(max_lib_size, pred_neighbors);
+            if(lib_size != lib_sizes.back())
+            {
+                LOG_WARNING("maximum lib size reached; ignoring remainder");
+            }
+            break;
+        }
+        else if(random_libs)
+        {
+            for(size_t k = 0; k < num_samples; ++k)
+            {
+                sample_random_lib(full_lib, lib_size);
+                find_all_pred_neighbors(pred_neighbors);
+                cross_map_all_targets(lib_size, pred_neighbors);
+            }
+        }
+        else
+        // no random libs and using contiguous segments
+        {
+            for(size_t k = 0; k < max_lib_size; ++k)
+            {
+                find_window_neighbors(full_lib, k, lib_size, pred_neighbors);
+                cross_map_all_targets(lib_size, pred_neighbors);
+            }
+        }
+    }
+    which_lib.swap(full_lib);
+    sorted_lib_positions.clear();
+    window_positions.clear();
+    
+    // targets and ranges were set up for all target columns
+    remake_targets = true;
+    remake_ranges = true;
+    flush_warnings();
+    return;
+}
+
+inline std::vector<PredStats> Xmap::get_stats()
+{
+    return predicted_stats;
+}
+
+inline const std::vector<StatsSummary>& Xmap::get_stats_summary() const
+{
+    return stats_summaries;
+}
+
+inline std::vector<size_t> Xmap::get_lib_sizes()
+{
+    return predicted_lib_sizes;
+}
+
+inline std::vector<size_t> Xmap::get_target_columns()
+{
+    return predicted_target_columns;
+}
+
+inline const ModelOutput& Xmap::get_output() const
+{
+    return model_output;
+}
+
+// *** PRIVATE METHODS FOR INTERNAL USE ONLY *** //
+
+inline void Xmap::prepare_forecast()
+{
+    if(remake_vectors)
+    {
+        make_vectors();
+        init_distances();
+    }
+    
+    if(remake_targets)
+        make_targets();
+        
+    if(remake_ranges)
+    {
+        set_indices_from_range(lib_indices, lib_ranges, (E-1)*tau, -std::max(0, tp), true);
+        set_indices_from_range(pred_indices, pred_ranges, (E-1)*tau, -std::max(0, tp), false);
+        set_pred_requested_indices_from_range(pred_requested_indices, pred_ranges);
+        
+        check_cross_validation();
+
+        which_lib = which_indices_true(lib_indices);
+        which_pred = which_indices_true(pred_indices);
+        
+        remake_ranges = false;
+    }
+    
+    compute_distances();
+    //sort_neighbors();
+    
+    return;
+}
+
+inline void Xmap::prepare_all_targets()
+{
+    if(remake_vectors)
+    {
+        make_vectors();
+        init_distances();
+    }
+    
+    // make targets for every requested column
+    size_t prev_target = target;
+    all_targets.clear();
+    for(auto col: target_columns)
+    {
+        target = col;
+        make_targets();
+        all_targets.push_back(targets);
+    }
+    target = prev_target;
+    if(all_targets.empty())
+    {
+        throw std::domain_error("no target columns given");
+    }
+    
+    // lib vectors need a valid target in every column
+    set_indices_from_range(lib_indices, lib_ranges, (E-1)*tau, -std::max(0, tp), false);
+    set_indices_from_range(pred_indices, pred_ranges, (E-1)*tau, -std::max(0, tp), false);
+    for(size_t i = 0; i < num_vectors; ++i)
+    {
+        for(auto& curr_targets: all_targets)
+        {
+            if(std::isnan(curr_targets[i]))
+            {
+                lib_indices[i] = false;
+                break;
+            }
+        }
+    }
+    
+    check_cross_validation();
+    
+    which_lib = which_indices_true(lib_indices);
+    which_pred = which_indices_true(pred_indices);
+    
+    compute_distances();
+    return;
+}
+
+inline void Xmap::sample_random_lib(const std::vector<size_t>& full_lib, const size_t lib_size)
+{
+    size_t max_lib_size = full_lib.size();
+    size_t m, t;
+    
+    which_lib.resize(lib_size, 0);
+    if(replace)
+    {
+        for(auto& lib: which_lib)
+        {
+            lib = full_lib[uniform(0, max_lib_size - 1)];
+        }
+    }
+    else
+    {
+        // sample without replacement (algorithm from Knuth)
+        m = 0;
+        t = 0;
+        while(m < lib_size)
+        {
+            if(uniform(0, max_lib_size - t) >= lib_size - m)
+            {
+                ++t;
+            }
+            else
+            {
+                which_lib[m] = full_lib[t];
+                ++t; ++m;
+            }
+        }
+    }
+    return;
+}
+
+inline double Xmap::uniform(const double a, const double b)
+{
+    if(uniform_generator)
+        return uniform_generator(a, b);
+    if(b <= a)
+        return a;
+    return std::uniform_real_distribution<double>(a, b)(rng);
+}
+
+inline std::vector<size_t> Xmap::sample_nested_lib(const std::vector<size_t>& full_lib, 
+                                             const size_t lib_size)
+{
+    size_t max_lib_size = full_lib.size();
+    std::vector<size_t> nested_lib;
+    
+    if(replace)
+    {
+        nested_lib.resize(lib_size, 0);
+        for(auto& lib: nested_lib)
+        {
+            lib = full_lib[uniform(0, max_lib_size - 1)];
+        }
+    }
+    else
+    {
+        // partial Fisher-Yates shuffle, so that every prefix is also a 
+        // random sample without replacement
+        nested_lib = full_lib;
+        size_t j;
+        for(size_t i = 0; i < lib_size; ++i)
+        {
+            j = i + size_t(uniform(0, max_lib_size - i));
+            if(j >= max_lib_size)
+                j = max_lib_size - 1;
+            std::swap(nested_lib[i], nested_lib[j]);
+        }
+        nested_lib.resize(lib_size);
+    }
+    return nested_lib;
+}
+
+inline void Xmap::run_nested_libs(const std::vector<size_t>& full_lib)
+{
+    size_t max_lib_size = full_lib.size();
+    size_t curr_pred, curr_lib, num_added;
+    
+    // lib sizes that are sampled; the full lib, if reached, is run once
+    std::vector<size_t> nested_sizes;
+    bool use_full_lib = false;
+    for(auto lib_size: lib_sizes)
+    {
+        if(lib_size >= max_lib_size && !replace)
+        {
+            use_full_lib = true;
+            break;
+        }
+        nested_sizes.push_back(lib_size);
+    }
+    
+    size_t num_sizes = nested_sizes.size();
+    std::vector<PredStats> nested_stats(num_sizes * num_samples);
+    std::vector<std::vector<size_t> > pred_neighbors(which_pred.size());
+    for(size_t k = 0; k < num_samples && num_sizes > 0; ++k)
+    {
+        // the lib for each size extends the lib for the previous size
+        std::vector<size_t> nested_lib = sample_nested_lib(full_lib, nested_sizes.back());
+        for(auto& nearest_neighbors: pred_neighbors)
+            nearest_neighbors.clear();
+        num_added = 0;
+        for(size_t s = 0; s < num_sizes; ++s)
+        {
+            predicted.assign(num_vectors, qnan);
+            predicted_var.assign(num_vectors, qnan);
+            for(size_t i = 0; i < which_pred.size(); ++i)
+            {
+                curr_pred = which_pred[i];
+                
+                // new lib vectors can only displace the farthest neighbors, 
+                // and only if they are within epsilon
+                {
+                    PhaseTimer timer(profiler(), PHASE_NEIGHBORS);
+                    DistanceRow dist = distance_row(curr_pred);
+                    for(size_t j = num_added; j < nested_sizes[s]; ++j)
+                    {
+                        curr_lib = nested_lib[j];
+                        if(CROSS_VALIDATION && is_lib_excluded(curr_pred, curr_lib))
+                            continue;
+                        if(epsilon >= 0 && dist[curr_lib] > epsilon)
+                            continue;
+                        insert_neighbor(pred_neighbors[i], dist, curr_lib);
+                    }
+                    if(PROFILING)
+                        profile.neighbors_examined += nested_sizes[s] - num_added;
+                }
+                
+                if(pred_neighbors[i].size() == 0)
+                {
+                    LOG_WARNING("no nearest neighbors found; using NA for forecast");
+                    continue;
+                }
+                simplex_estimate(curr_pred, pred_neighbors[i], pred_scratch);
+            }
+            num_added = nested_sizes[s];
+            
+            nested_stats[s * num_samples + k] = make_stats();
+            if(save_model_preds)
+            {
+                save_current_output(s * num_samples + k);
+            }
+        }
+    }
+    
+    // collect stats in the same order as for independent libs
+    for(size_t s = 0; s < num_sizes; ++s)
+    {
+        for(size_t k = 0; k < num_samples; ++k)
+        {
+            record_stats(nested_stats[s * num_samples + k], nested_sizes[s], target);
+        }
+    }
+    
+    if(use_full_lib)
+    {
+        if(lib_sizes[num_sizes] > max_lib_size)
+        {
+            LOG_WARNING("lib size request was larger than maximum available; corrected");
+        }
+        which_lib = full_lib; // use all lib vectors
+        forecast();
+        record_stats(make_stats(), max_lib_size, target);
+        if(save_model_preds)
+        {
+            save_current_output(num_sizes * num_samples);
+        }
+        if(num_sizes + 1 < lib_sizes.size())
+        {
+            LOG_WARNING("maximum lib size reached; ignoring remainder");
+        }
+    }
+    return;
+}
+
+inline void Xmap::find_all_pred_neighbors(std::vector<std::vector<size_t> >& pred_neighbors)
+{
+    pred_neighbors.resize(which_pred.size());
+    for(size_t i = 0; i < which_pred.size(); ++i)
+    {
+        find_pred_neighbors(which_pred[i], pred_neighbors[i], pred_scratch);
+    }
+    return;
+}
+
+inline void Xmap::forecast_from_neighbors(const std::vector<std::vector<size_t> >& pred_neighbors)
+{
+    predicted.assign(num_vectors, qnan);
+    predicted_var.assign(num_vectors, qnan);
+    for(size_t i = 0; i < which_pred.size(); ++i)
+    {
+        if(pred_neighbors[i].size() == 0)
+        {
+            LOG_WARNING("no nearest neighbors found; using NA for forecast");
+            continue;
+        }
+        simplex_estimate(which_pred[i], pred_neighbors[i], pred_scratch);
+    }
+    return;
+}
+
+inline void Xmap::cross_map_all_targets(const size_t lib_size, 
+                                 const std::vector<std::vector<size_t> >& pred_neighbors)
+{
+    size_t num_targets = all_targets.size();
+    size_t curr_pred, effective_nn;
+    const vec& weights = pred_scratch.weights;
+    double total_weight, pred;
+    std::vector<vec> all_predicted(num_targets, vec(num_vectors, qnan));
+    
+    // neighbors and weights depend only on the lib embedding, so compute 
+    // them once per pred and reuse them for every target column
+    for(size_t k = 0; k < which_pred.size(); ++k)
+    {
+        curr_pred = which_pred[k];
+        const std::vector<size_t>& nearest_neighbors = pred_neighbors[k];
+        effective_nn = nearest_neighbors.size();
+        if(effective_nn == 0)
+        {
+            LOG_WARNING("no nearest neighbors found; using NA for forecast");
+            continue;
+        }
+        simplex_weights(curr_pred, nearest_neighbors, pred_scratch);
+        total_weight = accumulate(weights.begin(), weights.end(), 0.0);
+        
+        for(size_t t = 0; t < num_targets; ++t)
+        {
+            const vec& curr_targets = all_targets[t];
+            pred = 0;
+            for(size_t i = 0; i < effective_nn; ++i)
+                pred += weights[i] * curr_targets[nearest_neighbors[i]];
+            all_predicted[t][curr_pred] = pred / total_weight;
+        }
+    }
+    
+    PhaseTimer timer(profiler(), PHASE_STATS);
+    for(size_t t = 0; t < num_targets; ++t)
+    {
+        record_stats(compute_stats_internal(all_targets[t], all_predicted[t]), lib_size, 
+                     target_columns[t]);
+    }
+    return;
+}
+
+inline void Xmap::record_stats(const PredStats& stats, const size_t lib_size, 
+                               const size_t target_column)
+{
+    if(!summarize_stats)
+    {
+        predicted_stats.push_back(stats);
+        predicted_lib_sizes.push_back(lib_size);
+        predicted_target_columns.push_back(target_column);
+        return;
+    }
+    
+    // the summaries are few (a lib size, or one per target column, at a time), 
+    // and the latest ones are the likeliest match
+    for(auto it = stats_summaries.rbegin(); it != stats_summaries.rend(); ++it)
+    {
+        if(it->lib_size == lib_size && it->target_column == target_column)
+        {
+            it->add(stats);
+            return;
+        }
+    }
+    stats_summaries.push_back(StatsSummary(lib_size, target_column));
+    stats_summaries.back().add(stats);
+    return;
+}
+
+// a rescan of the sorted lib walks about nn N / L positions to find nn 
+// neighbors in a window of L out of N lib vectors, and is needed on about 
+// 2 nn / L of the steps, so the sorted lists cost about 2 nn^2 N / L^2 per 
+// pred and step, against L for searching the window directly. They also 
+// hold a position per pred and lib vector, so they are only built for lib 
+// sizes past the crossover, L^3 >= c nn^2 N (with c = 0.75 measured, so 
+// L = 23 for nn = 4 and N = 1000), and never for nn = 0, which rescans on 
+// every step
+inline bool Xmap::sorts_window_neighbors(const size_t lib_size, const size_t max_lib_size) const
+{
+    const double sort_ratio = 0.75;
+    if(nn < 1 || max_lib_size > std::numeric_limits<uint32_t>::max())
+        return false;
+    double L = double(lib_size);
+    return L * L * L >= sort_ratio * double(nn) * double(nn) * double(max_lib_size);
+}
+
+inline void Xmap::find_window_neighbors(const std::vector<size_t>& full_lib, const size_t start, 
+                                        const size_t lib_size, 
+                                        std::vector<std::vector<size_t> >& pred_neighbors)
+{
+    if(sorts_window_neighbors(lib_size, full_lib.size()))
+    {
+        // consecutive windows differ by one lib vector in and one out
+        if(sorted_lib_positions.empty())
+            sort_lib_positions(full_lib);
+        update_window_neighbors(full_lib, start, lib_size);
+        get_window_neighbors(full_lib, pred_neighbors);
+        return;
+    }
+    
+    // the window, in lib order (it may loop around to the front)
+    size_t max_lib_size = full_lib.size();
+    if(start + lib_size > max_lib_size)
+    {
+        which_lib.assign(full_lib.begin(), full_lib.begin() + (start + lib_size - max_lib_size));
+        which_lib.insert(which_lib.end(), full_lib.begin() + start, full_lib.end());
+    }
+    else
+    {
+        which_lib.assign(full_lib.begin() + start, full_lib.begin() + start + lib_size);
+    }
+    find_all_pred_neighbors(pred_neighbors);
+    return;
+}
+
+inline void Xmap::sort_lib_positions(const std::vector<size_t>& full_lib)
+{
+    PhaseTimer timer(profiler(), PHASE_NEIGHBORS);
+    if(PROFILING)
+        profile.neighbors_examined += which_pred.size() * full_lib.size();
+    
+    // order the positions in full_lib by distance from each pred, so the 
+    // neighbors within any contiguous window are found by scanning from the front
+    std::vector<uint32_t> positions(full_lib.size());
+    std::iota(positions.begin(), positions.end(), 0);
+    sorted_lib_positions.resize(which_pred.size());
+    for(size_t i = 0; i < which_pred.size(); ++i)
+    {
+        DistanceRow dist = distance_row(which_pred[i]);
+        sorted_lib_positions[i] = positions;
+        std::stable_sort(sorted_lib_positions[i].begin(), sorted_lib_positions[i].end(), 
+                         [&](size_t p1, size_t p2) {
+                             return dist[full_lib[p1]] < dist[full_lib[p2]];});
+    }
+    return;
+}
+
+inline void Xmap::scan_window_neighbors(const std::vector<size_t>& full_lib, const size_t i, 
+                                 const size_t start, const size_t lib_size)
+{
+    size_t max_lib_size = full_lib.size();
+    size_t curr_pred = which_pred[i];
+    DistanceRow dist = distance_row(curr_pred);
+    std::vector<size_t>& neighbor_positions = window_positions[i];
+    double tie_distance = 0;
+    
+    neighbor_positions.clear();
+    for(auto pos: sorted_lib_positions[i])
+    {
+        if(PROFILING)
+            profile.neighbors_examined += 1;
+        
+        // skip lib vectors outside the window (which may loop around)
+        if((pos + max_lib_size - start) % max_lib_size >= lib_size)
+            continue;
+        if(CROSS_VALIDATION && is_lib_excluded(curr_pred, full_lib[pos]))
+            continue;
+        
+        // keep the nn nearest, plus any ties with the farthest of those, 
+        // that are within epsilon
+        if(nn >= 1 && neighbor_positions.size() >= nn && dist[full_lib[pos]] > tie_distance)
+            break;
+        if(epsilon >= 0 && dist[full_lib[pos]] > epsilon)
+            break;
+        neighbor_positions.push_back(pos);
+        if(neighbor_positions.size() == nn)
+            tie_distance = dist[full_lib[pos]];
+    }
+    return;
+}
+
+inline void Xmap::update_window_neighbors(const std::vector<size_t>& full_lib, const size_t start, 
+                                   const size_t lib_size)
+{
+    PhaseTimer timer(profiler(), PHASE_NEIGHBORS);
+    if(start == 0 || window_positions.size() != which_pred.size())
+    {
+        window_positions.assign(which_pred.size(), std::vector<size_t>());
+        for(size_t i = 0; i < which_pred.size(); ++i)
+            scan_window_neighbors(full_lib, i, start, lib_size);
+        return;
+    }
+    
+    // the window moved forward by one, dropping one lib vector and adding one
+    size_t removed = start - 1;
+    size_t added = (start + lib_size - 1) % full_lib.size();
+    size_t curr_pred;
+    bool rescan;
+    for(size_t i = 0; i < which_pred.size(); ++i)
+    {
+        curr_pred = which_pred[i];
+        DistanceRow dist = distance_row(curr_pred);
+        std::vector<size_t>& neighbor_positions = window_positions[i];
+        
+        rescan = (nn < 1) || 
+            (std::find(neighbor_positions.begin(), neighbor_positions.end(), removed) != 
+             neighbor_positions.end());
+        if(!rescan && !(CROSS_VALIDATION && is_lib_excluded(curr_pred, full_lib[added])) && 
+           !(epsilon >= 0 && dist[full_lib[added]] > epsilon))
+        {
+            // the added vector only matters if it is no farther than the nn-th neighbor
+            rescan = (neighbor_positions.size() < nn) || 
+                (dist[full_lib[added]] <= dist[full_lib[neighbor_positions[nn-1]]]);
+        }
+        if(rescan)
+            scan_window_neighbors(full_lib, i, start, lib_size);
+    }
+    return;
+}
+
+inline void Xmap::get_window_neighbors(const std::vector<size_t>& full_lib, 
+                                std::vector<std::vector<size_t> >& pred_neighbors)
+{
+    pred_neighbors.resize(which_pred.size());
+    for(size_t i = 0; i < which_pred.size(); ++i)
+    {
+        std::vector<size_t>& nearest_neighbors = pred_neighbors[i];
+        nearest_neighbors.clear();
+        for(auto pos: window_positions[i])
+            nearest_neighbors.push_back(full_lib[pos]);
+    }
+    return;
+}
+
+inline void Xmap::make_vectors()
+{
+    PhaseTimer timer(profiler(), PHASE_MAKE_VECTORS);
+    
+    if((lib_col < 1) || (lib_col-1 >= block.size()))
+    {
+        throw std::domain_error("invalid target column");
+    }
+    
+    auto time_series = block[lib_col-1];
+    data_vectors.assign(num_vectors, vec(E, qnan));
+
+    // beginning of lagged vectors cannot lag before start of time series
+    for(size_t i = 0; i < (unsigned int)((E-1)*tau); ++i)
+        for(size_t j = 0; j < (unsigned int)(E); ++j)
+            if(i >= j*tau)
+                data_vectors[i][j] = time_series[i - j * tau];
+    
+    // remaining lagged vectors
+    for(size_t i = (unsigned int)((E-1)*tau); i < num_vectors; ++i)
+        for(size_t j = 0; j < (unsigned int)(E); ++j)
+            data_vectors[i][j] = time_series[i - j * tau];
+            
+    remake_vectors = false;
+    return;
+}
+
+inline void Xmap::make_targets()
+{
+    if((target < 1) || (target-1 >= block.size()))
+    {
+        throw std::domain_error("invalid target column");
+    }
+    
+    targets.clear();
+    if(tp >= 0)
+    {
+        targets.assign(block[target-1].begin()+tp, block[target-1].end());
+        targets.insert(targets.end(), tp, qnan);
+        target_time.assign(time.begin()+tp, time.end());
+        target_time.insert(target_time.end(), tp, qnan);
+    }
+    else
+    {
+        targets.assign(block[target-1].begin(), block[target-1].end()+tp);
+        targets.insert(targets.begin(), -tp, qnan);
+        target_time.assign(time.begin(), time.end()+tp);
+        target_time.insert(target_time.begin(), -tp, qnan);
+    }
+    const_targets = block[target-1];
+    remake_targets = false;
+    return;
+}
+
+#endif
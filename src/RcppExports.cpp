@@ -6,6 +6,67 @@
 
 using namespace Rcpp;
 
+// compute_gp_native
+List compute_gp_native(const NumericMatrix x_lib, const NumericVector y_lib, const NumericVector params, const double mean_y, const double max_x_lib, const double var_y_lib, const NumericMatrix x_pred, const bool gradient, const bool cov_matrix, const double param_rescaling_tol);
+RcppExport SEXP _rEDM_compute_gp_native(SEXP x_libSEXP, SEXP y_libSEXP, SEXP paramsSEXP, SEXP mean_ySEXP, SEXP max_x_libSEXP, SEXP var_y_libSEXP, SEXP x_predSEXP, SEXP gradientSEXP, SEXP cov_matrixSEXP, SEXP param_rescaling_tolSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const NumericMatrix >::type x_lib(x_libSEXP);
+    Rcpp::traits::input_parameter< const NumericVector >::type y_lib(y_libSEXP);
+    Rcpp::traits::input_parameter< const NumericVector >::type params(paramsSEXP);
+    Rcpp::traits::input_parameter< const double >::type mean_y(mean_ySEXP);
+    Rcpp::traits::input_parameter< const double >::type max_x_lib(max_x_libSEXP);
+    Rcpp::traits::input_parameter< const double >::type var_y_lib(var_y_libSEXP);
+    Rcpp::traits::input_parameter< const NumericMatrix >::type x_pred(x_predSEXP);
+    Rcpp::traits::input_parameter< const bool >::type gradient(gradientSEXP);
+    Rcpp::traits::input_parameter< const bool >::type cov_matrix(cov_matrixSEXP);
+    Rcpp::traits::input_parameter< const double >::type param_rescaling_tol(param_rescaling_tolSEXP);
+    rcpp_result_gen = Rcpp::wrap(compute_gp_native(x_lib, y_lib, params, mean_y, max_x_lib, var_y_lib, x_pred, gradient, cov_matrix, param_rescaling_tol));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fit_gp_params_native
+NumericVector fit_gp_params_native(const NumericMatrix x_lib, const NumericVector y_lib, const NumericVector params_init, const double mean_y, const double max_x_lib, const double var_y_lib, const double param_rescaling_tol);
+RcppExport SEXP _rEDM_fit_gp_params_native(SEXP x_libSEXP, SEXP y_libSEXP, SEXP params_initSEXP, SEXP mean_ySEXP, SEXP max_x_libSEXP, SEXP var_y_libSEXP, SEXP param_rescaling_tolSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const NumericMatrix >::type x_lib(x_libSEXP);
+    Rcpp::traits::input_parameter< const NumericVector >::type y_lib(y_libSEXP);
+    Rcpp::traits::input_parameter< const NumericVector >::type params_init(params_initSEXP);
+    Rcpp::traits::input_parameter< const double >::type mean_y(mean_ySEXP);
+    Rcpp::traits::input_parameter< const double >::type max_x_lib(max_x_libSEXP);
+    Rcpp::traits::input_parameter< const double >::type var_y_lib(var_y_libSEXP);
+    Rcpp::traits::input_parameter< const double >::type param_rescaling_tol(param_rescaling_tolSEXP);
+    rcpp_result_gen = Rcpp::wrap(fit_gp_params_native(x_lib, y_lib, params_init, mean_y, max_x_lib, var_y_lib, param_rescaling_tol));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fit_predict_gp_batch
+List fit_predict_gp_batch(const List x_lib, const List y_lib, const List x_pred, const NumericMatrix params, const NumericVector mean_y, const NumericVector max_x_lib, const NumericVector var_y_lib, const IntegerVector chain, const bool fit_params, const bool cov_matrix, const double param_rescaling_tol, const size_t num_inducing, const std::string inducing_method, const size_t num_threads);
+RcppExport SEXP _rEDM_fit_predict_gp_batch(SEXP x_libSEXP, SEXP y_libSEXP, SEXP x_predSEXP, SEXP paramsSEXP, SEXP mean_ySEXP, SEXP max_x_libSEXP, SEXP var_y_libSEXP, SEXP chainSEXP, SEXP fit_paramsSEXP, SEXP cov_matrixSEXP, SEXP param_rescaling_tolSEXP, SEXP num_inducingSEXP, SEXP inducing_methodSEXP, SEXP num_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const List >::type x_lib(x_libSEXP);
+    Rcpp::traits::input_parameter< const List >::type y_lib(y_libSEXP);
+    Rcpp::traits::input_parameter< const List >::type x_pred(x_predSEXP);
+    Rcpp::traits::input_parameter< const NumericMatrix >::type params(paramsSEXP);
+    Rcpp::traits::input_parameter< const NumericVector >::type mean_y(mean_ySEXP);
+    Rcpp::traits::input_parameter< const NumericVector >::type max_x_lib(max_x_libSEXP);
+    Rcpp::traits::input_parameter< const NumericVector >::type var_y_lib(var_y_libSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector >::type chain(chainSEXP);
+    Rcpp::traits::input_parameter< const bool >::type fit_params(fit_paramsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type cov_matrix(cov_matrixSEXP);
+    Rcpp::traits::input_parameter< const double >::type param_rescaling_tol(param_rescaling_tolSEXP);
+    Rcpp::traits::input_parameter< const size_t >::type num_inducing(num_inducingSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type inducing_method(inducing_methodSEXP);
+    Rcpp::traits::input_parameter< const size_t >::type num_threads(num_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(fit_predict_gp_batch(x_lib, y_lib, x_pred, params, mean_y, max_x_lib, var_y_lib, chain, fit_params, cov_matrix, param_rescaling_tol, num_inducing, inducing_method, num_threads));
+    return rcpp_result_gen;
+END_RCPP
+}
 // compute_stats
 DataFrame compute_stats(std::vector<double> observed, std::vector<double> predicted);
 RcppExport SEXP _rEDM_compute_stats(SEXP observedSEXP, SEXP predictedSEXP) {
@@ -18,13 +79,81 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// shuffle_surrogates
+NumericMatrix shuffle_surrogates(const NumericVector values, const NumericVector baseline, const size_t num_surr, const double seed, const size_t num_threads);
+RcppExport SEXP _rEDM_shuffle_surrogates(SEXP valuesSEXP, SEXP baselineSEXP, SEXP num_surrSEXP, SEXP seedSEXP, SEXP num_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const NumericVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< const NumericVector >::type baseline(baselineSEXP);
+    Rcpp::traits::input_parameter< const size_t >::type num_surr(num_surrSEXP);
+    Rcpp::traits::input_parameter< const double >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< const size_t >::type num_threads(num_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(shuffle_surrogates(values, baseline, num_surr, seed, num_threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// ebisuzaki_surrogates
+NumericMatrix ebisuzaki_surrogates(const NumericVector ts, const size_t num_surr, const double seed, const size_t num_threads);
+RcppExport SEXP _rEDM_ebisuzaki_surrogates(SEXP tsSEXP, SEXP num_surrSEXP, SEXP seedSEXP, SEXP num_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const NumericVector >::type ts(tsSEXP);
+    Rcpp::traits::input_parameter< const size_t >::type num_surr(num_surrSEXP);
+    Rcpp::traits::input_parameter< const double >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< const size_t >::type num_threads(num_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(ebisuzaki_surrogates(ts, num_surr, seed, num_threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// twin_surrogate_indices
+IntegerMatrix twin_surrogate_indices(const List twins, const size_t num_surr, const bool phase_lock, const size_t T_period, const bool same_season, const double seed, const size_t num_threads);
+RcppExport SEXP _rEDM_twin_surrogate_indices(SEXP twinsSEXP, SEXP num_surrSEXP, SEXP phase_lockSEXP, SEXP T_periodSEXP, SEXP same_seasonSEXP, SEXP seedSEXP, SEXP num_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const List >::type twins(twinsSEXP);
+    Rcpp::traits::input_parameter< const size_t >::type num_surr(num_surrSEXP);
+    Rcpp::traits::input_parameter< const bool >::type phase_lock(phase_lockSEXP);
+    Rcpp::traits::input_parameter< const size_t >::type T_period(T_periodSEXP);
+    Rcpp::traits::input_parameter< const bool >::type same_season(same_seasonSEXP);
+    Rcpp::traits::input_parameter< const double >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< const size_t >::type num_threads(num_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(twin_surrogate_indices(twins, num_surr, phase_lock, T_period, same_season, seed, num_threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// find_twins
+List find_twins(const NumericMatrix block, const bool phase_lock, const size_t T_period, const NumericVector quantile_vec, const size_t min_num_twins);
+RcppExport SEXP _rEDM_find_twins(SEXP blockSEXP, SEXP phase_lockSEXP, SEXP T_periodSEXP, SEXP quantile_vecSEXP, SEXP min_num_twinsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const NumericMatrix >::type block(blockSEXP);
+    Rcpp::traits::input_parameter< const bool >::type phase_lock(phase_lockSEXP);
+    Rcpp::traits::input_parameter< const size_t >::type T_period(T_periodSEXP);
+    Rcpp::traits::input_parameter< const NumericVector >::type quantile_vec(quantile_vecSEXP);
+    Rcpp::traits::input_parameter< const size_t >::type min_num_twins(min_num_twinsSEXP);
+    rcpp_result_gen = Rcpp::wrap(find_twins(block, phase_lock, T_period, quantile_vec, min_num_twins));
+    return rcpp_result_gen;
+END_RCPP
+}
 
 RcppExport SEXP _rcpp_module_boot_block_lnlp_module();
 RcppExport SEXP _rcpp_module_boot_lnlp_module();
 RcppExport SEXP _rcpp_module_boot_xmap_module();
 
 static const R_CallMethodDef CallEntries[] = {
+    {"_rEDM_compute_gp_native", (DL_FUNC) &_rEDM_compute_gp_native, 10},
+    {"_rEDM_fit_gp_params_native", (DL_FUNC) &_rEDM_fit_gp_params_native, 7},
+    {"_rEDM_fit_predict_gp_batch", (DL_FUNC) &_rEDM_fit_predict_gp_batch, 14},
     {"_rEDM_compute_stats", (DL_FUNC) &_rEDM_compute_stats, 2},
+    {"_rEDM_shuffle_surrogates", (DL_FUNC) &_rEDM_shuffle_surrogates, 5},
+    {"_rEDM_ebisuzaki_surrogates", (DL_FUNC) &_rEDM_ebisuzaki_surrogates, 4},
+    {"_rEDM_twin_surrogate_indices", (DL_FUNC) &_rEDM_twin_surrogate_indices, 7},
+    {"_rEDM_find_twins", (DL_FUNC) &_rEDM_find_twins, 5},
     {"_rcpp_module_boot_block_lnlp_module", (DL_FUNC) &_rcpp_module_boot_block_lnlp_module, 0},
     {"_rcpp_module_boot_lnlp_module", (DL_FUNC) &_rcpp_module_boot_lnlp_module, 0},
     {"_rcpp_module_boot_xmap_module", (DL_FUNC) &_rcpp_module_boot_xmap_module, 0},
@@ -0,0 +1,151 @@
+#include "rcpp_adapters.h"
+#include <rEDM/block_lnlp.h>
+
+// *** R interface to BlockLNLP: converts arguments and outputs *** //
+
+void block_lnlp_set_time(BlockLNLP* block_lnlp, const NumericVector new_time)
+{
+    block_lnlp->set_time(as<vec>(new_time));
+    return;
+}
+
+void block_lnlp_set_block(BlockLNLP* block_lnlp, const NumericMatrix new_block)
+{
+    block_lnlp->set_block(columns_from_matrix(new_block));
+    return;
+}
+
+void block_lnlp_set_lib(BlockLNLP* block_lnlp, const NumericMatrix lib)
+{
+    block_lnlp->set_lib(ranges_from_matrix(lib));
+    return;
+}
+
+void block_lnlp_set_pred(BlockLNLP* block_lnlp, const NumericMatrix pred)
+{
+    block_lnlp->set_pred(ranges_from_matrix(pred));
+    return;
+}
+
+void block_lnlp_set_embedding(BlockLNLP* block_lnlp, const NumericVector new_embedding)
+{
+    block_lnlp->set_embedding(as<std::vector<size_t> >(new_embedding));
+    return;
+}
+
+void block_lnlp_run(BlockLNLP* block_lnlp)
+{
+    block_lnlp->set_warning_handler(r_warning);
+    block_lnlp->run();
+    return;
+}
+
+DataFrame block_lnlp_get_output(BlockLNLP* block_lnlp)
+{
+    return output_to_df(block_lnlp);
+}
+
+DataFrame block_lnlp_get_smap_coefficients(BlockLNLP* block_lnlp)
+{
+    return smap_coefficients_to_df(block_lnlp->get_smap_coefficients());
+}
+
+List block_lnlp_get_smap_coefficient_covariances(BlockLNLP* block_lnlp)
+{
+    return smap_coefficient_covariances_to_list(block_lnlp->get_smap_coefficient_covariances());
+}
+
+DataFrame block_lnlp_get_stats(BlockLNLP* block_lnlp)
+{
+    return lnlp_stats_to_df(block_lnlp->get_stats(), block_lnlp->get_const_stats());
+}
+
+void block_lnlp_enable_profiling(BlockLNLP* block_lnlp, const bool trace)
+{
+    block_lnlp->enable_profiling(trace);
+    return;
+}
+
+void block_lnlp_disable_profiling(BlockLNLP* block_lnlp)
+{
+    block_lnlp->disable_profiling();
+    return;
+}
+
+void block_lnlp_reset_profile(BlockLNLP* block_lnlp)
+{
+    block_lnlp->reset_profile();
+    return;
+}
+
+List block_lnlp_get_profile(BlockLNLP* block_lnlp)
+{
+    return profile_to_list(block_lnlp->get_profile());
+}
+
+void block_lnlp_write_profile_trace(BlockLNLP* block_lnlp, const std::string path)
+{
+    write_profile_trace(block_lnlp->get_profile(), path);
+    return;
+}
+
+void block_lnlp_set_approximate_neighbors(BlockLNLP* block_lnlp, const size_t search_k, const size_t num_trees, 
+                                          const unsigned long seed)
+{
+    block_lnlp->set_approximate_neighbors(search_k, num_trees, seed);
+    return;
+}
+
+double block_lnlp_get_approx_recall(BlockLNLP* block_lnlp)
+{
+    return block_lnlp->get_approx_recall();
+}
+
+void block_lnlp_set_pivot_index(BlockLNLP* block_lnlp, const size_t num_pivots)
+{
+    block_lnlp->set_pivot_index(num_pivots);
+    return;
+}
+
+void block_lnlp_set_single_precision(BlockLNLP* block_lnlp, const bool single)
+{
+    block_lnlp->set_single_precision(single);
+    return;
+}
+
+RCPP_MODULE(block_lnlp_module)
+{
+    class_<BlockLNLP>("BlockLNLP")
+    
+    .constructor()
+    
+    .method("set_time", &block_lnlp_set_time)
+    .method("set_block", &block_lnlp_set_block)
+    .method("set_norm", &BlockLNLP::set_norm)
+    .method("set_pred_type", &BlockLNLP::set_pred_type)
+    .method("set_lib", &block_lnlp_set_lib)
+    .method("set_pred", &block_lnlp_set_pred)
+    .method("set_exclusion_radius", &BlockLNLP::set_exclusion_radius)
+    .method("set_epsilon", &BlockLNLP::set_epsilon)
+    .method("set_embedding", &block_lnlp_set_embedding)
+    .method("set_target_column", &BlockLNLP::set_target_column)
+    .method("set_params", &BlockLNLP::set_params)
+    .method("set_theta", &BlockLNLP::set_theta)
+    .method("suppress_warnings", &BlockLNLP::suppress_warnings)
+    .method("save_smap_coefficients", &BlockLNLP::save_smap_coefficients)
+    .method("run", &block_lnlp_run)
+    .method("get_output", &block_lnlp_get_output)
+    .method("get_smap_coefficients", &block_lnlp_get_smap_coefficients)
+    .method("get_smap_coefficient_covariances", &block_lnlp_get_smap_coefficient_covariances)
+    .method("get_stats", &block_lnlp_get_stats)
+    .method("enable_profiling", &block_lnlp_enable_profiling)
+    .method("disable_profiling", &block_lnlp_disable_profiling)
+    .method("reset_profile", &block_lnlp_reset_profile)
+    .method("get_profile", &block_lnlp_get_profile)
+    .method("write_profile_trace", &block_lnlp_write_profile_trace)
+    .method("set_approximate_neighbors", &block_lnlp_set_approximate_neighbors)
+    .method("get_approx_recall", &block_lnlp_get_approx_recall)
+    .method("set_pivot_index", &block_lnlp_set_pivot_index)
+    .method("set_single_precision", &block_lnlp_set_single_precision)
+    ;
+}
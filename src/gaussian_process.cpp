@@ -0,0 +1,604 @@
+#include "gaussian_process.h"
+
+/*** Constructors ***/
+GaussianProcess::GaussianProcess(const MatrixXd& new_x_lib, const VectorXd& new_y_lib,
+                                 const double new_mean_y, const double new_max_x_lib,
+                                 const double new_var_y_lib, const double param_rescaling_tol):
+    x_lib(new_x_lib), y_centered(new_y_lib.array() - new_mean_y), mean_y(new_mean_y),
+    max_x_lib(new_max_x_lib), var_y_lib(new_var_y_lib),
+    v_e_min(param_rescaling_tol), v_e_max(1 - param_rescaling_tol),
+    eta_min(param_rescaling_tol), eta_max(1 - param_rescaling_tol),
+    phi(0), v_e(0), eta(0), eta_scaled(0), v_e_scaled(0),
+    log_likelihood_params(0), neg_log_likelihood(0)
+{
+}
+
+void GaussianProcess::set_params(const Vector3d& params)
+{
+    // transform parameters so that v_e and eta are constrained to (0, 1)
+    phi = exp(params(0)) / max_x_lib;
+    v_e = v_e_min + (v_e_max - v_e_min) / (1 + exp(-params(1)));
+    eta = eta_min + (eta_max - eta_min) / (1 + exp(-params(2)));
+    d_params << phi,
+        v_e * (v_e_max - v_e_min - v_e) / (v_e_max - v_e_min),
+        eta * (eta_max - eta_min - eta) / (eta_max - eta_min);
+
+    // Gaussian prior for phi with E(phi) = 1
+    double lambda_phi = M_PI / 2;
+    // Beta priors for v_e and eta (alpha = beta = 2)
+    double a_v_e = 2, b_v_e = 2;
+    double a_eta = 2, b_eta = 2;
+
+    log_likelihood_params = -0.5 * phi * phi / lambda_phi +
+        (a_v_e - 1) * log(v_e) + (b_v_e - 1) * log(1 - v_e) +
+        (a_eta - 1) * log(eta) + (b_eta - 1) * log(1 - eta);
+    d_log_likelihood_params << -phi / lambda_phi,
+        (a_v_e - 1) / v_e - (b_v_e - 1) / (1 - v_e),
+        (a_eta - 1) / eta - (b_eta - 1) / (1 - eta);
+
+    // v_e and eta are relative to the variance in y
+    eta_scaled = eta * var_y_lib;
+    v_e_scaled = v_e * var_y_lib;
+    return;
+}
+
+void GaussianProcess::compute(const bool gradient)
+{
+    size_t N = x_lib.rows();
+
+    // distances between lib points don't change with the params
+    if(squared_dist_lib_lib.rows() != x_lib.rows())
+        squared_dist_lib_lib = squared_distances(x_lib, x_lib);
+    kernel(squared_dist_lib_lib, K_lib_lib);
+    Sigma = K_lib_lib;
+    Sigma.diagonal().array() += v_e_scaled;
+    if(!Sigma.allFinite() || !(Sigma.array() > 0).all())
+    {
+        throw std::domain_error("Distance matrix is not positive-definite; Is the input data degenerate?");
+    }
+
+    // cholesky algorithm from Rasmussen & Williams (2006, algorithm 2.1)
+    llt.compute(Sigma);
+    if(llt.info() != Eigen::Success)
+    {
+        throw std::domain_error("Distance matrix is not positive-definite; Is the input data degenerate?");
+    }
+    alpha = llt.solve(y_centered);
+
+    // marginal likelihood
+    double log_likelihood_lib = -0.5 * y_centered.dot(alpha) -
+        llt.matrixLLT().diagonal().array().log().sum();
+    neg_log_likelihood = -(log_likelihood_lib + log_likelihood_params);
+
+    if(!gradient)
+        return;
+
+    // the gradient needs tr(Sigma_inv * dK) for each param; since 
+    // K = Sigma - v_e I, tr(Sigma_inv * K) = N - v_e * tr(Sigma_inv), so only 
+    // tr(Sigma_inv) and tr(Sigma_inv * W), with W = dK/dphi, are needed. With 
+    // B = L^-1 and A = L^-1 W, these are ||B||^2 and sum(A * B), which are 
+    // accumulated a block of columns at a time from the cholesky factor, so 
+    // Sigma_inv itself is never formed. Columns j of B are zero above j, so 
+    // only the trailing rows of each block of B need to be solved.
+    const size_t block_size = 64;
+    double alpha_W_alpha = 0;
+    double tr_Sigma_inv_W = 0;
+    double tr_Sigma_inv = 0;
+    MatrixXd A, B;
+    for(size_t j0 = 0; j0 < N; j0 += block_size)
+    {
+        size_t b = std::min(block_size, N - j0);
+        size_t n_tail = N - j0;
+        
+        // W = -2 * phi * sq_dist * K (zero on the diagonal)
+        A.resize(N, b);
+        A.array() = -2 * phi * squared_dist_lib_lib.middleCols(j0, b).array() * 
+            K_lib_lib.middleCols(j0, b).array();
+        alpha_W_alpha += alpha.segment(j0, b).dot(A.transpose() * alpha);
+        llt.matrixL().solveInPlace(A);
+        
+        B = MatrixXd::Identity(n_tail, b);
+        llt.matrixLLT().bottomRightCorner(n_tail, n_tail).
+            triangularView<Eigen::Lower>().solveInPlace(B);
+        tr_Sigma_inv += B.squaredNorm();
+        tr_Sigma_inv_W += A.bottomRows(n_tail).cwiseProduct(B).sum();
+    }
+    double alpha_alpha = alpha.squaredNorm();
+    double alpha_K_alpha = y_centered.dot(alpha) - v_e_scaled * alpha_alpha;
+    double tr_Sigma_inv_K = double(N) - v_e_scaled * tr_Sigma_inv;
+
+    Vector3d d_log_likelihood_lib;
+    d_log_likelihood_lib << 0.5 * (alpha_W_alpha - tr_Sigma_inv_W),
+        0.5 * (alpha_alpha - tr_Sigma_inv),
+        0.5 * (alpha_K_alpha - tr_Sigma_inv_K) / eta_scaled;
+
+    combine_gradient(d_log_likelihood_lib);
+    return;
+}
+
+void GaussianProcess::set_pred(const MatrixXd& x_pred, const bool cov_matrix)
+{
+    // distances involving pred points don't change with the params either
+    squared_dist_pred_lib = squared_distances(x_pred, x_lib);
+    if(cov_matrix)
+        squared_dist_pred_pred = squared_distances(x_pred, x_pred);
+    else
+        squared_dist_pred_pred.resize(0, 0);
+    return;
+}
+
+void GaussianProcess::predict(const bool cov_matrix)
+{
+    if(cov_matrix && squared_dist_pred_pred.rows() != squared_dist_pred_lib.rows())
+    {
+        throw std::domain_error("set_pred() was not called with cov_matrix = TRUE");
+    }
+    kernel(squared_dist_pred_lib, K_pred_lib);
+    mean_pred = (K_pred_lib * alpha).array() + mean_y;
+
+    // K_pred_lib * Sigma_inv * K_lib_pred = V^T V, with V = L^-1 K_lib_pred
+    MatrixXd V = llt.matrixL().solve(K_pred_lib.transpose());
+    if(cov_matrix)
+    {
+        // v_e is added to every entry, as in the original R implementation
+        kernel(squared_dist_pred_pred, covariance_pred);
+        covariance_pred.noalias() -= V.transpose() * V;
+        covariance_pred.array() += v_e_scaled;
+        pred_var = covariance_pred.diagonal();
+    }
+    else
+    {
+        covariance_pred.resize(0, 0);
+        pred_var = (eta_scaled + v_e_scaled) - V.colwise().squaredNorm().transpose().array();
+    }
+    return;
+}
+
+Vector3d GaussianProcess::fit_params(const Vector3d& params_init, const size_t max_iter,
+                                     const double delta_init, const double delta_min,
+                                     const double delta_max, const double eta_minus,
+                                     const double eta_plus)
+{
+    // function minimization using resilient backpropagation gradient descent
+    auto sign = [](const Vector3d& v) {
+        return Vector3d(v.unaryExpr([](double x) {return double((x > 0) - (x < 0));}));
+    };
+
+    // initial calulation of likelihood
+    Vector3d x = params_init;
+    set_params(x);
+    compute(true);
+    double val = neg_log_likelihood;
+    Vector3d grad = gradient_neg_log_likelihood;
+    double s = grad.norm();
+
+    size_t iter_count = 0;
+    Vector3d delta = Vector3d::Constant(delta_init);
+    double delta_f = 10;
+
+    // stop if gradient is 0, max iterations reached, or no change in output
+    while((s > 1e-4) && (iter_count < max_iter) && (delta_f > 1e-7))
+    {
+        // step 1: move
+        Vector3d x_new = x - sign(grad).cwiseProduct(delta);
+        set_params(x_new);
+        compute(true);
+        s = gradient_neg_log_likelihood.norm();
+        delta_f = fabs(neg_log_likelihood / val - 1);
+
+        // step 2: update step size
+        Vector3d grad_c = sign(grad).cwiseProduct(sign(gradient_neg_log_likelihood));
+        for(int k = 0; k < 3; ++k)
+        {
+            if(grad_c(k) > 0)
+                delta(k) *= eta_plus;
+            else if(grad_c(k) < 0)
+                delta(k) *= eta_minus;
+            delta(k) = std::min(delta_max, std::max(delta_min, delta(k)));
+        }
+
+        // step 3: reset
+        x = x_new;
+        val = neg_log_likelihood;
+        grad = gradient_neg_log_likelihood;
+        iter_count++;
+    }
+    return x;
+}
+
+double GaussianProcess::get_neg_log_likelihood() const
+{
+    return neg_log_likelihood;
+}
+
+Vector3d GaussianProcess::get_gradient() const
+{
+    return gradient_neg_log_likelihood;
+}
+
+const VectorXd& GaussianProcess::get_mean_pred() const
+{
+    return mean_pred;
+}
+
+const VectorXd& GaussianProcess::get_pred_var() const
+{
+    return pred_var;
+}
+
+const MatrixXd& GaussianProcess::get_covariance_pred() const
+{
+    return covariance_pred;
+}
+
+// *** PRIVATE METHODS FOR INTERNAL USE ONLY *** //
+
+MatrixXd GaussianProcess::squared_distances(const MatrixXd& x1, const MatrixXd& x2) const
+{
+    MatrixXd sq_dist(x1.rows(), x2.rows());
+    for(Eigen::Index j = 0; j < x2.rows(); ++j)
+        for(Eigen::Index i = 0; i < x1.rows(); ++i)
+            sq_dist(i, j) = (x1.row(i) - x2.row(j)).squaredNorm();
+    return sq_dist;
+}
+
+void GaussianProcess::kernel(const MatrixXd& squared_dist, MatrixXd& K) const
+{
+    kernel(squared_dist, K, phi, eta_scaled);
+    return;
+}
+
+void GaussianProcess::kernel(const MatrixXd& squared_dist, MatrixXd& K, const double phi_k, 
+                             const double eta_k) const
+{
+    // written in place with a vectorized exp, reusing K's storage
+    K.resize(squared_dist.rows(), squared_dist.cols());
+    K.array() = eta_k * (squared_dist.array() * (-phi_k * phi_k)).exp();
+    return;
+}
+
+void GaussianProcess::combine_gradient(const Vector3d& d_log_likelihood_lib)
+{
+    // J is gradient in parameter space:
+    // transform to get gradient in transformed parameters
+    Vector3d J = d_log_likelihood_lib + d_log_likelihood_params;
+    gradient_neg_log_likelihood = -J.cwiseProduct(d_params);
+    return;
+}
+
+/*** Sparse (FITC) GP ***/
+SparseGaussianProcess::SparseGaussianProcess(const MatrixXd& new_x_lib, const VectorXd& new_y_lib,
+                                             const double new_mean_y, const double new_max_x_lib,
+                                             const double new_var_y_lib, 
+                                             const double param_rescaling_tol, 
+                                             const MatrixXd& new_x_inducing):
+    GaussianProcess(new_x_lib, new_y_lib, new_mean_y, new_max_x_lib, new_var_y_lib, 
+                    param_rescaling_tol), 
+    x_inducing(new_x_inducing)
+{
+    squared_dist_ind_ind = squared_distances(x_inducing, x_inducing);
+    squared_dist_lib_ind = squared_distances(x_lib, x_inducing);
+}
+
+void SparseGaussianProcess::set_pred(const MatrixXd& x_pred, const bool cov_matrix)
+{
+    squared_dist_pred_ind = squared_distances(x_pred, x_inducing);
+    if(cov_matrix)
+        squared_dist_pred_pred = squared_distances(x_pred, x_pred);
+    else
+        squared_dist_pred_pred.resize(0, 0);
+    return;
+}
+
+double SparseGaussianProcess::log_likelihood_lib(const double phi_k, const double v_e_k, 
+                                                 const double eta_k)
+{
+    size_t m = x_inducing.rows();
+    MatrixXd K_ind_ind, K_lib_ind;
+    
+    // K_ind_ind = L_ind L_ind^T, with a little jitter for stability
+    kernel(squared_dist_ind_ind, K_ind_ind, phi_k, eta_k);
+    K_ind_ind.diagonal().array() += 1e-6 * eta_k;
+    llt_ind.compute(K_ind_ind);
+    if(llt_ind.info() != Eigen::Success)
+    {
+        throw std::domain_error("Inducing point covariance is not positive-definite; Are inducing points duplicated?");
+    }
+    
+    // Q = V^T V approximates K_lib_lib, and the FITC covariance is 
+    // Sigma = Q + Lambda, with Lambda = diag(K_lib_lib - Q) + v_e I
+    kernel(squared_dist_lib_ind, K_lib_ind, phi_k, eta_k);
+    V = llt_ind.matrixL().solve(K_lib_ind.transpose());
+    lambda = (eta_k + v_e_k) - V.colwise().squaredNorm().transpose().array();
+    if(!lambda.allFinite() || (lambda.array() <= 0).any())
+    {
+        throw std::domain_error("Distance matrix is not positive-definite; Is the input data degenerate?");
+    }
+    
+    // Woodbury identity and matrix determinant lemma, using
+    // A = I + V Lambda^-1 V^T = L_A L_A^T
+    MatrixXd V_scaled = V * lambda.cwiseInverse().asDiagonal();
+    MatrixXd A = MatrixXd::Identity(m, m);
+    A.noalias() += V_scaled * V.transpose();
+    llt_A.compute(A);
+    c = llt_A.matrixL().solve(V_scaled * y_centered);
+    double y_Sigma_inv_y = y_centered.cwiseAbs2().cwiseQuotient(lambda).sum() - c.squaredNorm();
+    double log_det_Sigma = lambda.array().log().sum() + 
+        2 * llt_A.matrixLLT().diagonal().array().log().sum();
+    return -0.5 * y_Sigma_inv_y - 0.5 * log_det_Sigma;
+}
+
+void SparseGaussianProcess::compute(const bool gradient)
+{
+    if(gradient)
+    {
+        // central differences with respect to (phi, v_e, eta) on the scales 
+        // used by the exact gradient; the priors are differentiated exactly
+        Vector3d x(phi, v_e_scaled, eta_scaled);
+        Vector3d d_log_likelihood_lib;
+        for(int k = 0; k < 3; ++k)
+        {
+            double h = 1e-5 * std::max(fabs(x(k)), 1e-3);
+            Vector3d x_plus = x, x_minus = x;
+            x_plus(k) += h;
+            x_minus(k) -= h;
+            d_log_likelihood_lib(k) = 
+                (log_likelihood_lib(x_plus(0), x_plus(1), x_plus(2)) - 
+                 log_likelihood_lib(x_minus(0), x_minus(1), x_minus(2))) / (2 * h);
+        }
+        combine_gradient(d_log_likelihood_lib);
+    }
+    
+    // the factorization is left at the current params for predict()
+    neg_log_likelihood = -(log_likelihood_lib(phi, v_e_scaled, eta_scaled) + 
+                           log_likelihood_params);
+    return;
+}
+
+void SparseGaussianProcess::predict(const bool cov_matrix)
+{
+    if(cov_matrix && squared_dist_pred_pred.rows() != squared_dist_pred_ind.rows())
+    {
+        throw std::domain_error("set_pred() was not called with cov_matrix = TRUE");
+    }
+    
+    // with V_pred = L_ind^-1 K_ind_pred and W_pred = L_A^-1 V_pred:
+    //   mean = V_pred^T L_A^-T c
+    //   cov  = K_pred_pred - V_pred^T V_pred + W_pred^T W_pred
+    MatrixXd K_pred_ind;
+    kernel(squared_dist_pred_ind, K_pred_ind);
+    MatrixXd V_pred = llt_ind.matrixL().solve(K_pred_ind.transpose());
+    MatrixXd W_pred = llt_A.matrixL().solve(V_pred);
+    VectorXd w = llt_A.matrixU().solve(c);
+    mean_pred = (V_pred.transpose() * w).array() + mean_y;
+    
+    if(cov_matrix)
+    {
+        // v_e is added to every entry, as for the exact GP
+        kernel(squared_dist_pred_pred, covariance_pred);
+        covariance_pred.noalias() -= V_pred.transpose() * V_pred;
+        covariance_pred.noalias() += W_pred.transpose() * W_pred;
+        covariance_pred.array() += v_e_scaled;
+        pred_var = covariance_pred.diagonal();
+    }
+    else
+    {
+        covariance_pred.resize(0, 0);
+        pred_var = (eta_scaled + v_e_scaled) - 
+            V_pred.colwise().squaredNorm().transpose().array() + 
+            W_pred.colwise().squaredNorm().transpose().array();
+    }
+    return;
+}
+
+MatrixXd select_inducing_points(const MatrixXd& x, const size_t num_inducing, 
+                                const std::string& method)
+{
+    size_t N = x.rows();
+    size_t m = std::min(num_inducing, N);
+    
+    // evenly spaced lib points
+    MatrixXd centers(m, x.cols());
+    for(size_t i = 0; i < m; ++i)
+        centers.row(i) = x.row(i * N / m);
+    if(method == "stride")
+        return centers;
+    if(method != "kmeans")
+    {
+        throw std::domain_error("unknown method for choosing inducing points");
+    }
+    
+    // k-means (Lloyd's algorithm), starting from the evenly spaced points
+    std::vector<size_t> cluster(N, m);
+    bool changed = true;
+    for(size_t iter = 0; iter < 50 && changed; ++iter)
+    {
+        changed = false;
+        for(size_t i = 0; i < N; ++i)
+        {
+            Eigen::Index nearest;
+            (centers.rowwise() - x.row(i)).rowwise().squaredNorm().minCoeff(&nearest);
+            if(size_t(nearest) != cluster[i])
+            {
+                cluster[i] = nearest;
+                changed = true;
+            }
+        }
+        
+        // empty clusters keep their previous center
+        MatrixXd sums = MatrixXd::Zero(m, x.cols());
+        std::vector<size_t> counts(m, 0);
+        for(size_t i = 0; i < N; ++i)
+        {
+            sums.row(cluster[i]) += x.row(i);
+            counts[cluster[i]]++;
+        }
+        for(size_t k = 0; k < m; ++k)
+            if(counts[k] > 0)
+                centers.row(k) = sums.row(k) / double(counts[k]);
+    }
+    return centers;
+}
+
+// *** R interface *** //
+
+// [[Rcpp::export]]
+List compute_gp_native(const NumericMatrix x_lib, const NumericVector y_lib,
+                       const NumericVector params, const double mean_y,
+                       const double max_x_lib, const double var_y_lib,
+                       const NumericMatrix x_pred, const bool gradient,
+                       const bool cov_matrix, const double param_rescaling_tol)
+{
+    if(params.size() != 3)
+    {
+        throw std::domain_error("params must be (phi, v_e, eta)");
+    }
+    GaussianProcess gp(as<MatrixXd>(x_lib), as<VectorXd>(y_lib),
+                       mean_y, max_x_lib, var_y_lib, param_rescaling_tol);
+    gp.set_params(as<VectorXd>(params));
+    gp.compute(gradient);
+
+    List output = List::create(Named("neg_log_likelihood") = gp.get_neg_log_likelihood());
+    if(gradient)
+    {
+        NumericVector grad = wrap(gp.get_gradient());
+        grad.attr("names") = CharacterVector::create("phi", "v_e", "eta");
+        output["gradient_neg_log_likelihood"] = grad;
+    }
+    if(x_pred.nrow() > 0)
+    {
+        gp.set_pred(as<MatrixXd>(x_pred), cov_matrix);
+        gp.predict(cov_matrix);
+        output["mean_pred"] = wrap(gp.get_mean_pred());
+        output["pred_var"] = wrap(gp.get_pred_var());
+        if(cov_matrix)
+            output["covariance_pred"] = wrap(gp.get_covariance_pred());
+    }
+    return output;
+}
+
+// [[Rcpp::export]]
+NumericVector fit_gp_params_native(const NumericMatrix x_lib, const NumericVector y_lib,
+                                   const NumericVector params_init, const double mean_y,
+                                   const double max_x_lib, const double var_y_lib,
+                                   const double param_rescaling_tol)
+{
+    if(params_init.size() != 3)
+    {
+        throw std::domain_error("params must be (phi, v_e, eta)");
+    }
+    GaussianProcess gp(as<MatrixXd>(x_lib), as<VectorXd>(y_lib),
+                       mean_y, max_x_lib, var_y_lib, param_rescaling_tol);
+    NumericVector best_params = wrap(gp.fit_params(as<VectorXd>(params_init)));
+    best_params.attr("names") = CharacterVector::create("phi", "v_e", "eta");
+    return best_params;
+}
+
+void fit_predict_gp(GPJob& job, const bool fit_params, const bool cov_matrix, 
+                    const double param_rescaling_tol, const size_t num_inducing, 
+                    const std::string& inducing_method)
+{
+    // one model per embedding, so the squared distances are computed once 
+    // for fitting and prediction; use the sparse GP if inducing points are 
+    // requested and there are fewer of them than lib points
+    std::unique_ptr<GaussianProcess> gp;
+    if(num_inducing > 0 && num_inducing < size_t(job.x_lib.rows()))
+    {
+        gp.reset(new SparseGaussianProcess(job.x_lib, job.y_lib, job.mean_y, job.max_x_lib, 
+                                           job.var_y_lib, param_rescaling_tol, 
+                                           select_inducing_points(job.x_lib, num_inducing, 
+                                                                  inducing_method)));
+    }
+    else
+    {
+        gp.reset(new GaussianProcess(job.x_lib, job.y_lib, job.mean_y, job.max_x_lib, 
+                                     job.var_y_lib, param_rescaling_tol));
+    }
+    gp->set_pred(job.x_pred, cov_matrix);
+    if(fit_params)
+        job.params = gp->fit_params(job.params);
+    gp->set_params(job.params);
+    gp->compute(false);
+    gp->predict(cov_matrix);
+    
+    job.mean_pred = gp->get_mean_pred();
+    job.pred_var = gp->get_pred_var();
+    job.covariance_pred = gp->get_covariance_pred();
+    return;
+}
+
+List gp_job_output(const GPJob& job, const bool cov_matrix)
+{
+    NumericVector out_params = wrap(job.params);
+    out_params.attr("names") = CharacterVector::create("phi", "v_e", "eta");
+    List output = List::create(Named("params") = out_params, 
+                               Named("mean_pred") = wrap(job.mean_pred), 
+                               Named("pred_var") = wrap(job.pred_var));
+    if(cov_matrix)
+        output["covariance_pred"] = wrap(job.covariance_pred);
+    return output;
+}
+
+// [[Rcpp::export]]
+List fit_predict_gp_batch(const List x_lib, const List y_lib, const List x_pred, 
+                          const NumericMatrix params, const NumericVector mean_y, 
+                          const NumericVector max_x_lib, const NumericVector var_y_lib, 
+                          const IntegerVector chain, 
+                          const bool fit_params, const bool cov_matrix, 
+                          const double param_rescaling_tol, const size_t num_inducing, 
+                          const std::string inducing_method, const size_t num_threads)
+{
+    size_t num_jobs = x_lib.size();
+    if(y_lib.size() != x_lib.size() || x_pred.size() != x_lib.size() || 
+       size_t(params.nrow()) != num_jobs || params.ncol() != 3 || 
+       size_t(mean_y.size()) != num_jobs || size_t(max_x_lib.size()) != num_jobs || 
+       size_t(var_y_lib.size()) != num_jobs || size_t(chain.size()) != num_jobs)
+    {
+        throw std::domain_error("every job needs x_lib, y_lib, x_pred, params, mean_y, max_x_lib, var_y_lib, and chain");
+    }
+    
+    // copy inputs out of R before starting any threads
+    std::vector<GPJob> jobs(num_jobs);
+    std::vector<std::vector<size_t> > chains;
+    for(size_t k = 0; k < num_jobs; ++k)
+    {
+        GPJob& job = jobs[k];
+        job.x_lib = as<MatrixXd>(x_lib[k]);
+        job.y_lib = as<VectorXd>(y_lib[k]);
+        job.x_pred = as<MatrixXd>(x_pred[k]);
+        job.params = Vector3d(params(k, 0), params(k, 1), params(k, 2));
+        job.mean_y = mean_y[k];
+        job.max_x_lib = max_x_lib[k];
+        job.var_y_lib = var_y_lib[k];
+        
+        if(chain[k] < 1)
+        {
+            throw std::domain_error("chain ids must be positive");
+        }
+        if(size_t(chain[k]) > chains.size())
+            chains.resize(chain[k]);
+        chains[chain[k] - 1].push_back(k);
+    }
+    
+    // chains are independent and run concurrently; jobs within a chain run 
+    // in order, each starting from the params fitted for the previous one, 
+    // so the results don't depend on the number of threads
+    parallel_for(chains.size(), num_threads, [&](size_t start, size_t end) {
+        for(size_t c = start; c < end; ++c)
+        {
+            for(size_t k = 0; k < chains[c].size(); ++k)
+            {
+                GPJob& job = jobs[chains[c][k]];
+                if(k > 0 && fit_params)
+                    job.params = jobs[chains[c][k-1]].params;
+                fit_predict_gp(job, fit_params, cov_matrix, param_rescaling_tol, 
+                               num_inducing, inducing_method);
+            }
+        }
+    });
+    
+    List output(num_jobs);
+    for(size_t k = 0; k < num_jobs; ++k)
+        output[k] = gp_job_output(jobs[k], cov_matrix);
+    return output;
+}
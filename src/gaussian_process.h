@@ -0,0 +1,141 @@
+#ifndef GAUSSIAN_PROCESS_H
+#define GAUSSIAN_PROCESS_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <math.h>
+#include <RcppEigen.h>
+#include "parallel.h"
+
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+using Eigen::Vector3d;
+using namespace Rcpp;
+
+// Gaussian process with a squared-exponential kernel, as described in
+// ?block_gp; params are on the unconstrained scale used by the optimizer
+class GaussianProcess
+{
+public:
+    // *** constructors *** //
+    GaussianProcess(const MatrixXd& new_x_lib, const VectorXd& new_y_lib,
+                    const double new_mean_y, const double new_max_x_lib,
+                    const double new_var_y_lib, const double param_rescaling_tol);
+    virtual ~GaussianProcess() {}
+
+    // *** methods *** //
+    void set_params(const Vector3d& params);
+    virtual void set_pred(const MatrixXd& x_pred, const bool cov_matrix);
+    virtual void compute(const bool gradient);
+    virtual void predict(const bool cov_matrix);
+    Vector3d fit_params(const Vector3d& params_init, const size_t max_iter = 200,
+                        const double delta_init = 0.1, const double delta_min = 1e-6,
+                        const double delta_max = 50, const double eta_minus = 0.5,
+                        const double eta_plus = 1.2);
+    double get_neg_log_likelihood() const;
+    Vector3d get_gradient() const;
+    const VectorXd& get_mean_pred() const;
+    const VectorXd& get_pred_var() const;
+    const MatrixXd& get_covariance_pred() const;
+
+protected:
+    MatrixXd squared_distances(const MatrixXd& x1, const MatrixXd& x2) const;
+    void kernel(const MatrixXd& squared_dist, MatrixXd& K) const;
+    void kernel(const MatrixXd& squared_dist, MatrixXd& K, const double phi_k, 
+                const double eta_k) const;
+    void combine_gradient(const Vector3d& d_log_likelihood_lib);
+
+    // *** data *** //
+    MatrixXd x_lib;
+    VectorXd y_centered;
+    double mean_y;
+    double max_x_lib;
+    double var_y_lib;
+    double v_e_min, v_e_max, eta_min, eta_max;
+    MatrixXd squared_dist_pred_pred;
+
+    // *** params and priors *** //
+    double phi, v_e, eta;
+    double eta_scaled, v_e_scaled;
+    Vector3d d_params;
+    double log_likelihood_params;
+    Vector3d d_log_likelihood_params;
+
+    // *** outputs *** //
+    double neg_log_likelihood;
+    Vector3d gradient_neg_log_likelihood;
+    VectorXd mean_pred;
+    VectorXd pred_var;
+    MatrixXd covariance_pred;
+
+private:
+    // *** exact GP distances and factorization *** //
+    MatrixXd squared_dist_lib_lib;
+    MatrixXd squared_dist_pred_lib;
+    MatrixXd K_lib_lib;
+    MatrixXd Sigma;
+    MatrixXd K_pred_lib;
+    Eigen::LLT<MatrixXd> llt;
+    VectorXd alpha;
+};
+
+// FITC approximation (Snelson & Ghahramani 2006) using m inducing points, for
+// O(N m^2) time and O(N m) memory; the params, priors and outputs are the 
+// same as for the exact GP
+class SparseGaussianProcess: public GaussianProcess
+{
+public:
+    // *** constructors *** //
+    SparseGaussianProcess(const MatrixXd& new_x_lib, const VectorXd& new_y_lib,
+                          const double new_mean_y, const double new_max_x_lib,
+                          const double new_var_y_lib, const double param_rescaling_tol, 
+                          const MatrixXd& new_x_inducing);
+    
+    // *** methods *** //
+    void set_pred(const MatrixXd& x_pred, const bool cov_matrix);
+    void compute(const bool gradient);
+    void predict(const bool cov_matrix);
+    
+private:
+    double log_likelihood_lib(const double phi_k, const double v_e_k, const double eta_k);
+    
+    // *** inducing points and distances *** //
+    MatrixXd x_inducing;
+    MatrixXd squared_dist_ind_ind;
+    MatrixXd squared_dist_lib_ind;
+    MatrixXd squared_dist_pred_ind;
+    
+    // *** factorization at the last likelihood evaluation *** //
+    Eigen::LLT<MatrixXd> llt_ind;
+    Eigen::LLT<MatrixXd> llt_A;
+    MatrixXd V;
+    VectorXd lambda;
+    VectorXd c;
+};
+
+MatrixXd select_inducing_points(const MatrixXd& x, const size_t num_inducing, 
+                                const std::string& method);
+
+// one fit-and-predict problem (an embedding and tp in block_gp); the inputs 
+// are copied out of R so that jobs can run on worker threads, and params 
+// holds the initial params on input and the fitted params on output
+struct GPJob
+{
+    MatrixXd x_lib;
+    VectorXd y_lib;
+    MatrixXd x_pred;
+    Vector3d params;
+    double mean_y, max_x_lib, var_y_lib;
+    
+    VectorXd mean_pred;
+    VectorXd pred_var;
+    MatrixXd covariance_pred;
+};
+
+void fit_predict_gp(GPJob& job, const bool fit_params, const bool cov_matrix, 
+                    const double param_rescaling_tol, const size_t num_inducing, 
+                    const std::string& inducing_method);
+
+#endif
@@ -0,0 +1,143 @@
+#include "rcpp_adapters.h"
+#include <rEDM/lnlp.h>
+
+// *** R interface to LNLP: converts arguments and outputs *** //
+
+void lnlp_set_time(LNLP* lnlp, const NumericVector new_time)
+{
+    lnlp->set_time(as<vec>(new_time));
+    return;
+}
+
+void lnlp_set_time_series(LNLP* lnlp, const NumericVector data)
+{
+    lnlp->set_time_series(as<vec>(data));
+    return;
+}
+
+void lnlp_set_lib(LNLP* lnlp, const NumericMatrix lib)
+{
+    lnlp->set_lib(ranges_from_matrix(lib));
+    return;
+}
+
+void lnlp_set_pred(LNLP* lnlp, const NumericMatrix pred)
+{
+    lnlp->set_pred(ranges_from_matrix(pred));
+    return;
+}
+
+void lnlp_run(LNLP* lnlp)
+{
+    lnlp->set_warning_handler(r_warning);
+    lnlp->run();
+    return;
+}
+
+DataFrame lnlp_get_output(LNLP* lnlp)
+{
+    return output_to_df(lnlp);
+}
+
+DataFrame lnlp_get_smap_coefficients(LNLP* lnlp)
+{
+    return smap_coefficients_to_df(lnlp->get_smap_coefficients());
+}
+
+List lnlp_get_smap_coefficient_covariances(LNLP* lnlp)
+{
+    return smap_coefficient_covariances_to_list(lnlp->get_smap_coefficient_covariances());
+}
+
+DataFrame lnlp_get_stats(LNLP* lnlp)
+{
+    return lnlp_stats_to_df(lnlp->get_stats(), lnlp->get_const_stats());
+}
+
+void lnlp_enable_profiling(LNLP* lnlp, const bool trace)
+{
+    lnlp->enable_profiling(trace);
+    return;
+}
+
+void lnlp_disable_profiling(LNLP* lnlp)
+{
+    lnlp->disable_profiling();
+    return;
+}
+
+void lnlp_reset_profile(LNLP* lnlp)
+{
+    lnlp->reset_profile();
+    return;
+}
+
+List lnlp_get_profile(LNLP* lnlp)
+{
+    return profile_to_list(lnlp->get_profile());
+}
+
+void lnlp_write_profile_trace(LNLP* lnlp, const std::string path)
+{
+    write_profile_trace(lnlp->get_profile(), path);
+    return;
+}
+
+void lnlp_set_approximate_neighbors(LNLP* lnlp, const size_t search_k, const size_t num_trees, 
+                                    const unsigned long seed)
+{
+    lnlp->set_approximate_neighbors(search_k, num_trees, seed);
+    return;
+}
+
+double lnlp_get_approx_recall(LNLP* lnlp)
+{
+    return lnlp->get_approx_recall();
+}
+
+void lnlp_set_pivot_index(LNLP* lnlp, const size_t num_pivots)
+{
+    lnlp->set_pivot_index(num_pivots);
+    return;
+}
+
+void lnlp_set_single_precision(LNLP* lnlp, const bool single)
+{
+    lnlp->set_single_precision(single);
+    return;
+}
+
+RCPP_MODULE(lnlp_module)
+{
+    class_<LNLP>("LNLP")
+    
+    .constructor()
+    
+    .method("set_time", &lnlp_set_time)
+    .method("set_time_series", &lnlp_set_time_series)
+    .method("set_norm", &LNLP::set_norm)
+    .method("set_pred_type", &LNLP::set_pred_type)
+    .method("set_lib", &lnlp_set_lib)
+    .method("set_pred", &lnlp_set_pred)
+    .method("set_exclusion_radius", &LNLP::set_exclusion_radius)
+    .method("set_epsilon", &LNLP::set_epsilon)
+    .method("set_params", &LNLP::set_params)
+    .method("set_theta", &LNLP::set_theta)
+    .method("suppress_warnings", &LNLP::suppress_warnings)
+    .method("save_smap_coefficients", &LNLP::save_smap_coefficients)
+    .method("run", &lnlp_run)
+    .method("get_output", &lnlp_get_output)
+    .method("get_smap_coefficients", &lnlp_get_smap_coefficients)
+    .method("get_smap_coefficient_covariances", &lnlp_get_smap_coefficient_covariances)
+    .method("get_stats", &lnlp_get_stats)
+    .method("enable_profiling", &lnlp_enable_profiling)
+    .method("disable_profiling", &lnlp_disable_profiling)
+    .method("reset_profile", &lnlp_reset_profile)
+    .method("get_profile", &lnlp_get_profile)
+    .method("write_profile_trace", &lnlp_write_profile_trace)
+    .method("set_approximate_neighbors", &lnlp_set_approximate_neighbors)
+    .method("get_approx_recall", &lnlp_get_approx_recall)
+    .method("set_pivot_index", &lnlp_set_pivot_index)
+    .method("set_single_precision", &lnlp_set_single_precision)
+    ;
+}
@@ -0,0 +1,59 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <vector>
+#include <thread>
+#include <exception>
+#include <algorithm>
+
+// split [0, n) into contiguous blocks and call f(start, end) for each block
+// in its own thread; f must not call into R
+template<typename F>
+void parallel_for(const size_t n, const size_t num_threads, F f)
+{
+    size_t num_workers = std::min(std::max(num_threads, size_t(1)), n);
+    if(num_workers <= 1)
+    {
+        f(0, n);
+        return;
+    }
+
+    size_t rows = n / num_workers;
+    size_t extra = n % num_workers;
+    size_t start = 0;
+    size_t end = rows;
+    std::vector<std::thread> workers;
+    std::vector<std::exception_ptr> errors(num_workers);
+
+    for(size_t t = 0; t < num_workers; ++t)
+    {
+        if(t == num_workers - 1)
+            end += extra;
+
+        // set up calculations to be done
+        workers.push_back(std::thread([&f, &errors, t, start, end]() {
+            try
+            {
+                f(start, end);
+            }
+            catch(...)
+            {
+                errors[t] = std::current_exception();
+            }
+        }));
+
+        // set up rows for next calc
+        start = end;
+        end = start + rows;
+    }
+
+    // wait for threads to finish, then pass on the first error
+    for(auto& tt: workers)
+        tt.join();
+    for(auto& err: errors)
+        if(err)
+            std::rethrow_exception(err);
+    return;
+}
+
+#endif
@@ -0,0 +1,168 @@
+#include "rcpp_adapters.h"
+
+std::vector<time_range> ranges_from_matrix(const NumericMatrix ranges)
+{
+    size_t num_rows = size_t(ranges.nrow());
+    std::vector<time_range> output(num_rows);
+    for(size_t i = 0; i < num_rows; ++i)
+    {
+        output[i].first = ranges(i,0) - 1; // convert 1-index to 0-index
+        output[i].second = ranges(i,1) - 1;
+    }
+    return output;
+}
+
+std::vector<vec> columns_from_matrix(const NumericMatrix block)
+{
+    size_t num_cols = size_t(block.ncol());
+    size_t num_rows = size_t(block.nrow());
+    std::vector<vec> output(num_cols);
+    for(size_t i = 0; i < num_cols; ++i)
+    {
+        output[i].resize(num_rows);
+        for(size_t j = 0; j < num_rows; ++j)
+            output[i][j] = block(j,i);
+    }
+    return output;
+}
+
+List model_output_to_list(const ModelOutput& output)
+{
+    // one data frame per model; they share the time and obs columns, which 
+    // R copies only if one is modified
+    size_t num_rows = output.num_rows();
+    NumericVector time = wrap(output.time);
+    NumericVector obs = wrap(output.obs);
+    List model_output(output.num_models);
+    for(size_t k = 0; k < output.num_models; ++k)
+    {
+        vec::const_iterator pred = output.pred.begin() + k * num_rows;
+        vec::const_iterator pred_var = output.pred_var.begin() + k * num_rows;
+        model_output[k] = DataFrame::create( Named("time") = time, 
+                                             Named("obs") = obs, 
+                                             Named("pred") = NumericVector(pred, pred + num_rows), 
+                                             Named("pred_var") = NumericVector(pred_var, 
+                                                                               pred_var + num_rows));
+    }
+    return model_output;
+}
+
+DataFrame smap_coefficients_to_df(const std::vector<vec>& coefficients)
+{
+    size_t embed_dim = coefficients.size();
+    List tmp_lst(embed_dim);
+    CharacterVector df_names(embed_dim);
+    for(size_t j = 0; j < embed_dim; ++j)
+    {
+        tmp_lst[j] = coefficients[j];
+        df_names[j] = "c_" + std::to_string(j+1);
+    }
+    df_names[embed_dim - 1] = "c_0";
+    DataFrame df(tmp_lst);
+    df.attr("names") = df_names;
+    return(df);
+}
+
+List smap_coefficient_covariances_to_list(const PackedCovariances& covariances)
+{
+    // NULL where no covariance was computed
+    size_t dim = covariances.dim;
+    List tmp_lst(covariances.size());
+    for(size_t k = 0; k < covariances.size(); ++k)
+    {
+        if(!covariances.computed[k])
+            continue;
+        const double* packed = covariances.matrix(k);
+        NumericMatrix cov(dim, dim);
+        for(size_t i = 0; i < dim; ++i)
+        {
+            for(size_t j = i; j < dim; ++j)
+            {
+                cov(i, j) = *packed;
+                cov(j, i) = *packed++;
+            }
+        }
+        tmp_lst[k] = cov;
+    }
+    return(tmp_lst);
+}
+
+double rho_to_r(const PredStats& stats)
+{
+    return std::isnan(stats.rho) ? NA_REAL : stats.rho;
+}
+
+double p_val_to_r(const PredStats& stats)
+{
+    return std::isnan(stats.rho) ? NA_REAL : stats.p_val;
+}
+
+DataFrame lnlp_stats_to_df(const PredStats& output, const PredStats& const_output)
+{
+    return DataFrame::create( Named("num_pred") = output.num_pred, 
+                              Named("rho") = rho_to_r(output), 
+                              Named("mae") = output.mae, 
+                              Named("rmse") = output.rmse,
+                              Named("perc") = output.perc, 
+                              Named("p_val") = p_val_to_r(output), 
+                              Named("const_pred_num_pred") = const_output.num_pred, 
+                              Named("const_pred_rho") = rho_to_r(const_output), 
+                              Named("const_pred_mae") = const_output.mae, 
+                              Named("const_pred_rmse") = const_output.rmse, 
+                              Named("const_pred_perc") = const_output.perc, 
+                              Named("const_p_val") = p_val_to_r(const_output));
+}
+
+List profile_to_list(const ForecastProfile& profile)
+{
+    CharacterVector phase(NUM_PROFILE_PHASES);
+    NumericVector seconds(NUM_PROFILE_PHASES);
+    NumericVector calls(NUM_PROFILE_PHASES);
+    for(size_t k = 0; k < NUM_PROFILE_PHASES; ++k)
+    {
+        phase[k] = profile_phase_name(ProfilePhase(k));
+        seconds[k] = profile.seconds[k];
+        calls[k] = double(profile.calls[k]);
+    }
+    return List::create(Named("phases") = DataFrame::create(Named("phase") = phase, 
+                                                            Named("seconds") = seconds, 
+                                                            Named("calls") = calls, 
+                                                            Named("stringsAsFactors") = false), 
+                        Named("distance_evaluations") = double(profile.distance_evaluations), 
+                        Named("distances_abandoned") = double(profile.distances_abandoned), 
+                        Named("candidates_pruned") = double(profile.candidates_pruned), 
+                        Named("neighbors_examined") = double(profile.neighbors_examined), 
+                        Named("svd_calls") = double(profile.svd_calls), 
+                        Named("warnings") = double(profile.warnings), 
+                        Named("distance_bytes") = double(profile.distance_bytes), 
+                        Named("trace_events") = double(profile.events.size()));
+}
+
+void write_profile_trace(const ForecastProfile& profile, const std::string& path)
+{
+    std::ofstream out(path.c_str());
+    if(!out)
+    {
+        throw std::domain_error("unable to open " + path);
+    }
+    out << profile.trace_json();
+    return;
+}
+
+void r_warning(const char* warning_text)
+{
+    Rcpp::warning(warning_text);
+    return;
+}
+
+// [[Rcpp::export]]
+DataFrame compute_stats(std::vector<double> observed, std::vector<double> predicted)
+{
+    PredStats output = compute_stats_internal(observed, predicted);
+    return DataFrame::create( Named("num_pred") = output.num_pred,
+                              Named("rho") = rho_to_r(output),
+                              Named("mae") = output.mae,
+                              Named("rmse") = output.rmse,
+                              Named("perc") = output.perc,
+                              Named("p_val") = p_val_to_r(output));
+}
@@ -0,0 +1,47 @@
+#ifndef RCPP_ADAPTERS_H
+#define RCPP_ADAPTERS_H
+
+#include <string>
+#include <fstream>
+#include <RcppEigen.h>
+#include <rEDM/forecast_machine.h>
+
+using namespace Rcpp;
+
+// conversions between R objects and the types used by the forecasting engine
+
+// 2-column matrix of 1-indexed (start, end) rows to 0-indexed ranges
+std::vector<time_range> ranges_from_matrix(const NumericMatrix ranges);
+std::vector<vec> columns_from_matrix(const NumericMatrix block);
+List model_output_to_list(const ModelOutput& output);
+DataFrame smap_coefficients_to_df(const std::vector<vec>& coefficients);
+List smap_coefficient_covariances_to_list(const PackedCovariances& covariances);
+DataFrame lnlp_stats_to_df(const PredStats& stats, const PredStats& const_stats);
+List profile_to_list(const ForecastProfile& profile);
+void write_profile_trace(const ForecastProfile& profile, const std::string& path);
+
+// cor() in R gives NA (not NaN) for undefined correlations, which carries 
+// through to the p-value
+double rho_to_r(const PredStats& stats);
+double p_val_to_r(const PredStats& stats);
+
+void r_warning(const char* warning_text);
+
+// forecasts of a single model (LNLP or BlockLNLP), written by the engine 
+// straight into the columns of the data frame
+template<class Model>
+DataFrame output_to_df(Model* model)
+{
+    size_t num_rows = model->get_output_size();
+    NumericVector time(num_rows);
+    NumericVector obs(num_rows);
+    NumericVector pred(num_rows);
+    NumericVector pred_var(num_rows);
+    model->get_output(time.begin(), obs.begin(), pred.begin(), pred_var.begin());
+    return DataFrame::create( Named("time") = time, 
+                              Named("obs") = obs, 
+                              Named("pred") = pred, 
+                              Named("pred_var") = pred_var);
+}
+
+#endif
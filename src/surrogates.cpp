@@ -0,0 +1,350 @@
+#include "surrogates.h"
+#include <complex>
+#include <unsupported/Eigen/FFT>
+
+// *** random shuffle (and seasonal) surrogates *** //
+
+// [[Rcpp::export]]
+NumericMatrix shuffle_surrogates(const NumericVector values, const NumericVector baseline,
+                                 const size_t num_surr, const double seed,
+                                 const size_t num_threads)
+{
+    size_t n = values.size();
+    if(baseline.size() != values.size())
+    {
+        throw std::domain_error("baseline and values must be the same length");
+    }
+    vec x = as<vec>(values);
+    vec base = as<vec>(baseline);
+    NumericMatrix output(n, num_surr);
+    double* out = output.begin();
+
+    parallel_for(num_surr, num_threads, [&](size_t start, size_t end) {
+        for(size_t s = start; s < end; ++s)
+        {
+            RandomStream rng(static_cast<uint32_t>(seed), static_cast<uint32_t>(s));
+            double* col = out + s * n;
+            std::copy(x.begin(), x.end(), col);
+
+            // Fisher-Yates shuffle
+            for(size_t i = n; i > 1; --i)
+                std::swap(col[i-1], col[rng.index(i)]);
+            for(size_t i = 0; i < n; ++i)
+                col[i] += base[i];
+        }
+    });
+    return output;
+}
+
+// *** Ebisuzaki (phase randomization) surrogates *** //
+
+// [[Rcpp::export]]
+NumericMatrix ebisuzaki_surrogates(const NumericVector ts, const size_t num_surr,
+                                   const double seed, const size_t num_threads)
+{
+    typedef std::complex<double> cplx;
+
+    size_t n = ts.size();
+    size_t n2 = n / 2;
+    vec x = as<vec>(ts);
+    NumericMatrix output(n, num_surr);
+    double* out = output.begin();
+    if(n < 2)
+    {
+        throw std::domain_error("time series is too short for phase randomization");
+    }
+
+    // standard deviation of the original time series
+    double mean = std::accumulate(x.begin(), x.end(), 0.0) / n;
+    double sigma = 0;
+    for(auto& xi: x)
+        sigma += (xi - mean) * (xi - mean);
+    sigma = sqrt(sigma / (n - 1));
+
+    // forward transform once; only the amplitudes are kept
+    std::vector<cplx> spectrum;
+    Eigen::FFT<double> fft;
+    fft.fwd(spectrum, x);
+    vec amplitudes(n);
+    for(size_t k = 0; k < n; ++k)
+        amplitudes[k] = std::abs(spectrum[k]);
+    amplitudes[0] = 0;
+
+    parallel_for(num_surr, num_threads, [&](size_t start, size_t end) {
+        Eigen::FFT<double> worker_fft; // plans are not shared across threads
+        std::vector<cplx> recf(n);
+        vec temp(n);
+        double theta, temp_mean, temp_sd;
+        for(size_t s = start; s < end; ++s)
+        {
+            RandomStream rng(static_cast<uint32_t>(seed), static_cast<uint32_t>(s));
+
+            // random phases, keeping the spectrum conjugate symmetric
+            recf[0] = cplx(0, 0);
+            size_t num_phases = (n % 2 == 0) ? n2 - 1 : n2;
+            for(size_t k = 1; k <= num_phases; ++k)
+            {
+                theta = 2 * M_PI * rng.uniform();
+                recf[k] = std::polar(amplitudes[k], theta);
+                recf[n-k] = std::conj(recf[k]);
+            }
+            if(n % 2 == 0) // Nyquist frequency is real
+                recf[n2] = cplx(sqrt(2.0) * amplitudes[n2] * cos(2 * M_PI * rng.uniform()), 0);
+            worker_fft.inv(temp, recf);
+
+            // adjust variance of the surrogate time series to match original
+            temp_mean = std::accumulate(temp.begin(), temp.end(), 0.0) / n;
+            temp_sd = 0;
+            for(auto& ti: temp)
+                temp_sd += (ti - temp_mean) * (ti - temp_mean);
+            temp_sd = sqrt(temp_sd / (n - 1));
+            double* col = out + s * n;
+            for(size_t i = 0; i < n; ++i)
+                col[i] = temp[i] / temp_sd * sigma;
+        }
+    });
+    return output;
+}
+
+// *** twin surrogates *** //
+
+// [[Rcpp::export]]
+IntegerMatrix twin_surrogate_indices(const List twins, const size_t num_surr,
+                                     const bool phase_lock, const size_t T_period,
+                                     const bool same_season, const double seed,
+                                     const size_t num_threads)
+{
+    // twins are 1-indexed, as returned by identify_twins()
+    size_t n = twins.size();
+    if(n < 2)
+    {
+        throw std::domain_error("time series is too short for twin surrogates");
+    }
+    std::vector<std::vector<int> > twin_list(n);
+    for(size_t i = 0; i < n; ++i)
+        twin_list[i] = as<std::vector<int> >(twins[i]);
+
+    // candidates for the initial point of the surrogate
+    std::vector<int> initial_candidates;
+    if(phase_lock && same_season)
+    {
+        for(size_t t = 1 + T_period; t <= n - 1; t += T_period)
+            initial_candidates.push_back(int(t));
+    }
+    else if(phase_lock)
+    {
+        initial_candidates = twin_list[0];
+    }
+    else
+    {
+        for(size_t t = 1; t <= n - 1; ++t)
+            initial_candidates.push_back(int(t));
+    }
+    if(initial_candidates.size() == 0)
+    {
+        throw std::domain_error("no candidates for the initial point of the surrogate");
+    }
+
+    // each surrogate gets up to max_tries attempts to avoid the end of the series
+    const size_t max_tries = 30;
+    std::vector<int> surr(n * num_surr, 0);
+    std::vector<char> valid(num_surr, 0); // not vector<bool>, which shares bytes
+
+    parallel_for(num_surr, num_threads, [&](size_t start, size_t end) {
+        std::vector<int> candidates;
+        for(size_t s = start; s < end; ++s)
+        {
+            RandomStream rng(static_cast<uint32_t>(seed), static_cast<uint32_t>(s));
+            int* col = &surr[s * n];
+            for(size_t tries = 0; tries < max_tries && !valid[s]; ++tries)
+            {
+                col[0] = initial_candidates[rng.index(initial_candidates.size())];
+                for(size_t j = 1; j < n; ++j)
+                {
+                    col[j] = 0;
+                    if(col[j-1] == 0) // out of next points already
+                        continue;
+
+                    // can't choose the end of the time series, or resync to
+                    // the original time series
+                    candidates.clear();
+                    for(auto c: twin_list[col[j-1] - 1])
+                    {
+                        if(c >= int(n))
+                            continue;
+                        if(phase_lock && same_season && c == int(j))
+                            continue;
+                        candidates.push_back(c);
+                    }
+                    if(candidates.size() > 0)
+                        col[j] = candidates[rng.index(candidates.size())] + 1;
+                }
+                valid[s] = (col[n-1] != 0);
+            }
+        }
+    });
+
+    // only return the valid surrogates
+    size_t num_valid = std::count(valid.begin(), valid.end(), 1);
+    IntegerMatrix output(n, num_valid);
+    size_t k = 0;
+    for(size_t s = 0; s < num_surr; ++s)
+    {
+        if(!valid[s])
+            continue;
+        std::copy(surr.begin() + s * n, surr.begin() + (s + 1) * n,
+                  output.begin() + k * n);
+        ++k;
+    }
+    return output;
+}
+
+// *** twin identification *** //
+
+// type 7 quantile (the R default) of the full N x N distance matrix, given 
+// only the upper triangle; the matrix has N zeros on the diagonal and every 
+// off-diagonal distance twice, so the sorted matrix is never formed
+double distance_matrix_quantile(vec& upper_dist, const size_t N, const double prob)
+{
+    double n = double(N) * double(N);
+    double index = 1 + (n - 1) * prob;
+    size_t lo = size_t(floor(index)) - 1; // 0-indexed order statistics
+    size_t hi = size_t(ceil(index)) - 1;
+    
+    // k-th value of the full sorted matrix
+    auto full_order_stat = [&](size_t k) {
+        if(k < N)
+            return 0.0;
+        size_t r = (k - N) / 2;
+        std::nth_element(upper_dist.begin(), upper_dist.begin() + r, upper_dist.end());
+        return upper_dist[r];
+    };
+    
+    double q_lo = full_order_stat(lo);
+    if(index <= lo + 1)
+        return q_lo;
+    double q_hi = full_order_stat(hi);
+    if(q_hi == q_lo)
+        return q_lo;
+    double h = index - (lo + 1);
+    return (1 - h) * q_lo + h * q_hi;
+}
+
+// [[Rcpp::export]]
+List find_twins(const NumericMatrix block, const bool phase_lock, const size_t T_period, 
+                const NumericVector quantile_vec, const size_t min_num_twins)
+{
+    size_t N = block.nrow();
+    size_t num_cols = block.ncol();
+    size_t num_words = (N + 63) / 64;
+    if(N < 2)
+    {
+        throw std::domain_error("block is too short to identify twins");
+    }
+    
+    // max norm distances between rows of the block (upper triangle only), 
+    // from a row-major copy so that each row is contiguous
+    vec rows(N * num_cols);
+    for(size_t i = 0; i < N; ++i)
+        for(size_t k = 0; k < num_cols; ++k)
+            rows[i * num_cols + k] = block(i, k);
+    auto max_dist = [&](size_t i, size_t j, double bound) {
+        return linf_distance(rows.data() + i * num_cols, rows.data() + j * num_cols, 
+                             num_cols, bound);
+    };
+    vec upper_dist;
+    upper_dist.reserve(N * (N - 1) / 2);
+    for(size_t i = 0; i < N; ++i)
+        for(size_t j = i + 1; j < N; ++j)
+            upper_dist.push_back(max_dist(i, j, std::numeric_limits<double>::infinity()));
+    
+    std::vector<uint64_t> recurrence(N * num_words);
+    std::vector<uint64_t> row_hash(N);
+    std::vector<size_t> order(N);
+    std::vector<size_t> twin_group(N);
+    
+    for(auto s: quantile_vec)
+    {
+        // make recurrence matrix, packed as bitsets: 1 if distance > threshold
+        double threshold = distance_matrix_quantile(upper_dist, N, s);
+        std::fill(recurrence.begin(), recurrence.end(), 0);
+        for(size_t i = 0; i < N; ++i)
+        {
+            for(size_t j = i + 1; j < N; ++j)
+            {
+                // only whether the distance is over threshold matters
+                if(max_dist(i, j, threshold) > threshold)
+                {
+                    recurrence[i * num_words + j / 64] |= uint64_t(1) << (j % 64);
+                    recurrence[j * num_words + i / 64] |= uint64_t(1) << (i % 64);
+                }
+            }
+        }
+        
+        // hash the rows (FNV-1a over the words), then group identical rows 
+        // by sorting on the hash and checking candidates word by word
+        for(size_t i = 0; i < N; ++i)
+        {
+            uint64_t h = 14695981039346656037ULL;
+            for(size_t w = 0; w < num_words; ++w)
+                h = (h ^ recurrence[i * num_words + w]) * 1099511628211ULL;
+            row_hash[i] = h;
+        }
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), 
+                         [&](size_t a, size_t b) {return row_hash[a] < row_hash[b];});
+        std::vector<size_t> roots; // distinct rows within a run of equal hashes
+        for(size_t k = 0; k < N; ++k)
+        {
+            size_t i = order[k];
+            if(k == 0 || row_hash[order[k-1]] != row_hash[i])
+                roots.clear();
+            twin_group[i] = i;
+            for(auto j: roots)
+            {
+                if(std::equal(recurrence.begin() + i * num_words, 
+                              recurrence.begin() + (i + 1) * num_words, 
+                              recurrence.begin() + j * num_words))
+                {
+                    twin_group[i] = j;
+                    break;
+                }
+            }
+            if(twin_group[i] == i)
+                roots.push_back(i);
+        }
+        std::vector<std::vector<size_t> > group_members(N);
+        for(size_t i = 0; i < N; ++i)
+            group_members[twin_group[i]].push_back(i);
+        
+        // generate twins (each point is its own twin)
+        std::vector<std::vector<int> > twins(N);
+        size_t num_twins = 0;
+        for(size_t i = 0; i < N; ++i)
+        {
+            for(auto j: group_members[twin_group[i]])
+            {
+                if(phase_lock && (std::max(i, j) - std::min(i, j)) % T_period != 0)
+                    continue;
+                twins[i].push_back(int(j + 1));
+                if(j != i)
+                    ++num_twins;
+            }
+        }
+        
+        // check for enough twins
+        if(num_twins >= min_num_twins)
+        {
+            List output(N);
+            CharacterVector names(N);
+            for(size_t i = 0; i < N; ++i)
+            {
+                output[i] = wrap(twins[i]);
+                names[i] = std::to_string(i + 1);
+            }
+            output.attr("names") = names;
+            return output;
+        }
+    }
+    return List();
+}
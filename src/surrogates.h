@@ -0,0 +1,50 @@
+#ifndef SURROGATES_H
+#define SURROGATES_H
+
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <RcppEigen.h>
+#include <rEDM/data_types.h>
+#include <rEDM/distance.h>
+#include "parallel.h"
+
+using namespace Rcpp;
+
+// independent random stream for each surrogate, so that the output depends
+// only on the seed and not on the number of threads
+class RandomStream
+{
+public:
+    RandomStream(const uint32_t seed, const uint32_t stream)
+    {
+        std::seed_seq seq{seed, stream};
+        engine.seed(seq);
+    }
+
+    // uniform on [0, 1), using the top 53 bits
+    double uniform()
+    {
+        return double(engine() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // uniform on {0, ..., n-1}, without modulo bias
+    size_t index(const size_t n)
+    {
+        uint64_t range = uint64_t(n);
+        uint64_t limit = UINT64_MAX - UINT64_MAX % range;
+        uint64_t x;
+        do
+        {
+            x = engine();
+        } while(x >= limit);
+        return size_t(x % range);
+    }
+
+private:
+    std::mt19937_64 engine;
+};
+
+double distance_matrix_quantile(vec& upper_dist, const size_t N, const double prob);
+
+#endif
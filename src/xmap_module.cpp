@@ -0,0 +1,274 @@
+#include "rcpp_adapters.h"
+#include <rEDM/xmap.h>
+
+// *** R interface to Xmap: converts arguments and outputs *** //
+
+void xmap_set_time(Xmap* xmap, const NumericVector new_time)
+{
+    xmap->set_time(as<vec>(new_time));
+    return;
+}
+
+void xmap_set_block(Xmap* xmap, const NumericMatrix new_block)
+{
+    xmap->set_block(columns_from_matrix(new_block));
+    return;
+}
+
+void xmap_set_lib(Xmap* xmap, const NumericMatrix lib)
+{
+    xmap->set_lib(ranges_from_matrix(lib));
+    return;
+}
+
+void xmap_set_pred(Xmap* xmap, const NumericMatrix pred)
+{
+    xmap->set_pred(ranges_from_matrix(pred));
+    return;
+}
+
+void xmap_set_lib_sizes(Xmap* xmap, const NumericVector new_lib_sizes)
+{
+    xmap->set_lib_sizes(as<std::vector<size_t> >(new_lib_sizes));
+    return;
+}
+
+void xmap_set_target_columns(Xmap* xmap, const NumericVector new_targets)
+{
+    xmap->set_target_columns(as<std::vector<size_t> >(new_targets));
+    return;
+}
+
+// random libs are drawn from R's RNG, so that results follow set.seed()
+void use_r_session(Xmap* xmap)
+{
+    xmap->set_warning_handler(r_warning);
+    xmap->set_uniform_generator([](double a, double b) {return R::runif(a, b);});
+    return;
+}
+
+void xmap_run(Xmap* xmap)
+{
+    use_r_session(xmap);
+    xmap->run();
+    return;
+}
+
+void xmap_run_all_targets(Xmap* xmap)
+{
+    use_r_session(xmap);
+    xmap->run_all_targets();
+    return;
+}
+
+DataFrame xmap_get_stats(Xmap* xmap)
+{
+    std::vector<size_t> num_pred;
+    std::vector<double> rho;
+    std::vector<double> mae;
+    std::vector<double> rmse;
+
+    for(auto& stats: xmap->get_stats())
+    {
+        num_pred.push_back(stats.num_pred);
+        rho.push_back(rho_to_r(stats));
+        mae.push_back(stats.mae);
+        rmse.push_back(stats.rmse);
+    }
+
+    return DataFrame::create( Named("lib_size") = xmap->get_lib_sizes(), 
+                              Named("num_pred") = num_pred, 
+                              Named("rho") = rho, 
+                              Named("mae") = mae, 
+                              Named("rmse") = rmse );
+}
+
+DataFrame xmap_get_all_target_stats(Xmap* xmap)
+{
+    std::vector<size_t> num_pred;
+    std::vector<double> rho;
+    std::vector<double> mae;
+    std::vector<double> rmse;
+    
+    for(auto& stats: xmap->get_stats())
+    {
+        num_pred.push_back(stats.num_pred);
+        rho.push_back(rho_to_r(stats));
+        mae.push_back(stats.mae);
+        rmse.push_back(stats.rmse);
+    }
+    
+    return DataFrame::create( Named("lib_size") = xmap->get_lib_sizes(), 
+                              Named("target_column") = xmap->get_target_columns(), 
+                              Named("num_pred") = num_pred, 
+                              Named("rho") = rho, 
+                              Named("mae") = mae, 
+                              Named("rmse") = rmse );
+}
+
+// NA where a summary is undefined (e.g. no samples with a defined rho)
+double summary_to_r(const double x)
+{
+    return std::isnan(x) ? NA_REAL : x;
+}
+
+void add_summary_columns(List& columns, std::vector<std::string>& names, 
+                                const std::string& stat, 
+                                const std::vector<const RunningSummary*>& summaries)
+{
+    size_t n = summaries.size();
+    NumericVector mean(n), sd(n), lower(n), median(n), upper(n);
+    for(size_t i = 0; i < n; ++i)
+    {
+        mean[i] = summary_to_r(summaries[i]->mean());
+        sd[i] = summary_to_r(std::sqrt(summaries[i]->variance()));
+        lower[i] = summary_to_r(summaries[i]->lower());
+        median[i] = summary_to_r(summaries[i]->median());
+        upper[i] = summary_to_r(summaries[i]->upper());
+    }
+    columns.push_back(mean);
+    names.push_back(stat);
+    columns.push_back(sd);
+    names.push_back(stat + "_sd");
+    columns.push_back(lower);
+    names.push_back(stat + "_lower");
+    columns.push_back(median);
+    names.push_back(stat + "_median");
+    columns.push_back(upper);
+    names.push_back(stat + "_upper");
+    return;
+}
+
+DataFrame xmap_get_stats_summary(Xmap* xmap)
+{
+    const std::vector<StatsSummary>& summaries = xmap->get_stats_summary();
+    size_t n = summaries.size();
+    std::vector<size_t> lib_size(n), target_column(n), num_samples(n);
+    NumericVector num_pred(n);
+    std::vector<const RunningSummary*> rho(n), mae(n), rmse(n);
+    for(size_t i = 0; i < n; ++i)
+    {
+        lib_size[i] = summaries[i].lib_size;
+        target_column[i] = summaries[i].target_column;
+        num_samples[i] = summaries[i].num_samples;
+        num_pred[i] = summary_to_r(summaries[i].num_pred.mean());
+        rho[i] = &summaries[i].rho;
+        mae[i] = &summaries[i].mae;
+        rmse[i] = &summaries[i].rmse;
+    }
+    
+    List columns;
+    std::vector<std::string> names;
+    columns.push_back(wrap(lib_size));
+    names.push_back("lib_size");
+    columns.push_back(wrap(target_column));
+    names.push_back("target_column");
+    columns.push_back(wrap(num_samples));
+    names.push_back("num_samples");
+    columns.push_back(num_pred);
+    names.push_back("num_pred");
+    add_summary_columns(columns, names, "rho", rho);
+    add_summary_columns(columns, names, "mae", mae);
+    add_summary_columns(columns, names, "rmse", rmse);
+    DataFrame df(columns);
+    df.attr("names") = wrap(names);
+    return df;
+}
+
+List xmap_get_output(Xmap* xmap)
+{
+    return model_output_to_list(xmap->get_output());
+}
+
+void xmap_enable_profiling(Xmap* xmap, const bool trace)
+{
+    xmap->enable_profiling(trace);
+    return;
+}
+
+void xmap_disable_profiling(Xmap* xmap)
+{
+    xmap->disable_profiling();
+    return;
+}
+
+void xmap_reset_profile(Xmap* xmap)
+{
+    xmap->reset_profile();
+    return;
+}
+
+List xmap_get_profile(Xmap* xmap)
+{
+    return profile_to_list(xmap->get_profile());
+}
+
+void xmap_write_profile_trace(Xmap* xmap, const std::string path)
+{
+    write_profile_trace(xmap->get_profile(), path);
+    return;
+}
+
+void xmap_set_approximate_neighbors(Xmap* xmap, const size_t search_k, const size_t num_trees, 
+                                    const unsigned long seed)
+{
+    xmap->set_approximate_neighbors(search_k, num_trees, seed);
+    return;
+}
+
+double xmap_get_approx_recall(Xmap* xmap)
+{
+    return xmap->get_approx_recall();
+}
+
+void xmap_set_pivot_index(Xmap* xmap, const size_t num_pivots)
+{
+    xmap->set_pivot_index(num_pivots);
+    return;
+}
+
+void xmap_set_single_precision(Xmap* xmap, const bool single)
+{
+    xmap->set_single_precision(single);
+    return;
+}
+
+RCPP_MODULE(xmap_module)
+{
+    class_<Xmap>("Xmap")
+    
+    .constructor()
+    
+    .method("set_time", &xmap_set_time)
+    .method("set_block", &xmap_set_block)
+    .method("set_norm", &Xmap::set_norm)
+    .method("set_lib", &xmap_set_lib)
+    .method("set_pred", &xmap_set_pred)
+    .method("set_lib_sizes", &xmap_set_lib_sizes)
+    .method("set_exclusion_radius", &Xmap::set_exclusion_radius)
+    .method("set_epsilon", &Xmap::set_epsilon)
+    .method("set_lib_column", &Xmap::set_lib_column)
+    .method("set_target_column", &Xmap::set_target_column)
+    .method("set_target_columns", &xmap_set_target_columns)
+    .method("set_params", &Xmap::set_params)
+    .method("enable_model_output", &Xmap::enable_model_output)
+    .method("enable_nested_libs", &Xmap::enable_nested_libs)
+    .method("enable_stats_summary", &Xmap::enable_stats_summary)
+    .method("suppress_warnings", &Xmap::suppress_warnings)
+    .method("run", &xmap_run)
+    .method("run_all_targets", &xmap_run_all_targets)
+    .method("get_stats", &xmap_get_stats)
+    .method("get_all_target_stats", &xmap_get_all_target_stats)
+    .method("get_stats_summary", &xmap_get_stats_summary)
+    .method("get_output", &xmap_get_output)
+    .method("enable_profiling", &xmap_enable_profiling)
+    .method("disable_profiling", &xmap_disable_profiling)
+    .method("reset_profile", &xmap_reset_profile)
+    .method("get_profile", &xmap_get_profile)
+    .method("write_profile_trace", &xmap_write_profile_trace)
+    .method("set_approximate_neighbors", &xmap_set_approximate_neighbors)
+    .method("get_approx_recall", &xmap_get_approx_recall)
+    .method("set_pivot_index", &xmap_set_pivot_index)
+    .method("set_single_precision", &xmap_set_single_precision)
+    ;
+}